@@ -0,0 +1,103 @@
+// Comparison and hashing benchmark for the optimal layout tuple
+//
+// Written in 2026 by the flamingdangerzone contributors
+//
+// To the extent possible under law, the author(s) have dedicated all copyright and related
+// and neighboring rights to this software to the public domain worldwide. This software is
+// distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along with this software.
+// If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+//
+// Sorts keys, and inserts them into and looks them up in an unordered_set, with my::tuple and
+// with std::tuple of the same element types. std::tuple has no std::hash, so it gets the usual
+// hasher that combines the hash of each element.
+//
+//     g++ -std=c++11 -O2 -o compare_bench compare_bench.c++ && ./compare_bench [count]
+
+#include "tuple.h++"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+    template <typename... T>
+    struct std_tuple_hash {
+        std::size_t operator()(std::tuple<T...> const& t) const {
+            return combine(t, my::IndicesUpTo<sizeof...(T)>{});
+        }
+
+    private:
+        template <std::size_t... I>
+        static std::size_t combine(std::tuple<T...> const& t, my::indices<I...>) {
+            std::uint64_t h = sizeof...(T);
+            (void)my::swallow{ 0, (h = my::hash_mix(h, std::hash<T>{}(std::get<I>(t))), 0)... };
+            return static_cast<std::size_t>(h);
+        }
+    };
+
+    template <typename Key>
+    struct hasher : std::hash<Key> {};
+    template <typename... T>
+    struct hasher<std::tuple<T...>> : std_tuple_hash<T...> {};
+
+    // keep the optimizer from dropping the work
+    volatile std::size_t sink;
+
+    template <typename Function>
+    double seconds(Function f) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template <typename Key, typename Make>
+    void run(char const* name, std::vector<std::uint64_t> const& seeds, Make make) {
+        std::vector<Key> keys;
+        keys.reserve(seeds.size());
+        for(auto seed : seeds) keys.push_back(make(seed));
+
+        auto sorted = keys;
+        double sort_time = seconds([&] { std::sort(sorted.begin(), sorted.end()); });
+        sink = std::unique(sorted.begin(), sorted.end()) - sorted.begin();
+
+        std::unordered_set<Key, hasher<Key>> set;
+        set.reserve(keys.size());
+        double insert_time = seconds([&] { for(auto const& k : keys) set.insert(k); });
+        std::size_t found = 0;
+        double lookup_time = seconds([&] { for(auto const& k : keys) found += set.count(k); });
+        sink = found + set.size();
+
+        std::printf("%-12s %10.3f %10.3f %10.3f\n", name, sort_time, insert_time, lookup_time);
+    }
+
+    // every field takes few values, so that many keys share their leading fields and
+    // comparisons have to go deep
+    template <typename Tuple>
+    Tuple make_key(std::uint64_t seed) {
+        return Tuple(std::uint16_t(seed % 7), std::uint64_t(seed / 7 % 11), std::uint8_t(seed / 77 % 3),
+                     std::uint32_t(seed / 231 % 13), std::uint16_t(seed / 3003));
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::mt19937_64 random(42);
+    std::vector<std::uint64_t> seeds(count);
+    for(auto& s : seeds) s = random() % (count / 2 + 1);
+
+    using my_key = my::tuple<std::uint16_t, std::uint64_t, std::uint8_t, std::uint32_t, std::uint16_t>;
+    using std_key = std::tuple<std::uint16_t, std::uint64_t, std::uint8_t, std::uint32_t, std::uint16_t>;
+    std::printf("%zu keys, %zu bytes with my::tuple, %zu bytes with std::tuple\n",
+                count, sizeof(my_key), sizeof(std_key));
+    std::printf("%-12s %10s %10s %10s\n", "seconds", "sort", "insert", "lookup");
+    run<std_key>("std::tuple", seeds, make_key<std_key>);
+    run<my_key>("my::tuple", seeds, make_key<my_key>);
+}
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+# Compile-time benchmark for the optimal layout tuple
+#
+# Written in 2026 by the flamingdangerzone contributors
+#
+# To the extent possible under law, the author(s) have dedicated all copyright and related
+# and neighboring rights to this software to the public domain worldwide. This software is
+# distributed without any warranty.
+#
+# You should have received a copy of the CC0 Public Domain Dedication along with this software.
+# If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+#
+# Generates a translation unit with a my::tuple of N random element types, accesses every
+# element, copies and compares it, and reports how long the compiler took and how much memory
+# it used, for each N.
+#
+#     ./compile_bench.py [--compiler g++] [--std c++11] [--sizes 8 16 ... 512]
+
+import argparse
+import os
+import random
+import resource
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+POOL = [
+    'char', 'bool', 'short', 'int', 'long', 'long long', 'float', 'double', 'long double',
+    'odd3', 'odd5', 'odd6', 'odd12', 'wide16', 'empty',
+]
+
+PRELUDE = '''#include "tuple.h++"
+
+struct odd3 { char c[3]; };
+struct odd5 { char c[5]; };
+struct odd6 { short s[3]; };
+struct odd12 { int i[3]; };
+struct alignas(16) wide16 { char c[16]; };
+struct empty {};
+
+// the contents do not matter here, only that comparisons instantiate
+#define COMPARABLE(T) \
+    inline bool operator==(T const&, T const&) { return true; } \
+    inline bool operator<(T const&, T const&) { return false; }
+COMPARABLE(odd3) COMPARABLE(odd5) COMPARABLE(odd6) COMPARABLE(odd12) COMPARABLE(wide16) COMPARABLE(empty)
+
+template <typename T>
+int touch(T const&) { return sizeof(T); }
+'''
+
+
+def generate(n, rng):
+    types = [rng.choice(POOL) for _ in range(n)]
+    lines = [PRELUDE, 'using record = my::tuple<{}>;'.format(', '.join(types)), '', 'int main() {']
+    lines.append('    record r;')
+    lines.append('    record copy = r;')
+    lines.append('    int total = 0;')
+    for i in range(n):
+        lines.append('    total += touch(my::get<{}>(r));'.format(i))
+    lines.append('    return total + (r == copy);')
+    lines.append('}')
+    return '\n'.join(lines) + '\n'
+
+
+def measure(compiler, std, source):
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, 'bench.c++')
+        with open(path, 'w') as f:
+            f.write(source)
+        command = [compiler, '-std=' + std, '-I', HERE, '-fsyntax-only', path]
+        before = resource.getrusage(resource.RUSAGE_CHILDREN)
+        start = time.perf_counter()
+        result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        elapsed = time.perf_counter() - start
+        after = resource.getrusage(resource.RUSAGE_CHILDREN)
+        if result.returncode != 0:
+            sys.stderr.write(result.stderr.decode(errors='replace')[:2000] + '\n')
+            return None
+        # ru_maxrss is the peak of any child so far, in kilobytes on Linux
+        return elapsed, max(before.ru_maxrss, after.ru_maxrss) / 1024.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--compiler', default=os.environ.get('CXX', 'g++'))
+    parser.add_argument('--std', default='c++11')
+    parser.add_argument('--sizes', type=int, nargs='+', default=[8, 16, 32, 64, 128, 256, 512])
+    parser.add_argument('--seed', type=int, default=42)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    print('{:>6} {:>10} {:>12}'.format('N', 'seconds', 'peak MiB'))
+    for n in args.sizes:
+        # every size runs in a fresh process so that the peak memory is its own
+        source = generate(n, rng)
+        child = subprocess.run([sys.executable, __file__, '--measure-one', args.compiler, args.std],
+                               input=source.encode(), stdout=subprocess.PIPE)
+        if child.returncode != 0:
+            print('{:>6} {:>10} {:>12}'.format(n, 'failed', '-'))
+            continue
+        seconds, peak = child.stdout.decode().split()
+        print('{:>6} {:>10.2f} {:>12.1f}'.format(n, float(seconds), float(peak)))
+        sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    if len(sys.argv) == 4 and sys.argv[1] == '--measure-one':
+        measured = measure(sys.argv[2], sys.argv[3], sys.stdin.read())
+        if measured is None:
+            sys.exit(1)
+        print('{} {}'.format(*measured))
+    else:
+        main()
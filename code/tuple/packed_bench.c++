@@ -0,0 +1,89 @@
+// Size and scan benchmark for the bit-packed tuple
+//
+// Written in 2026 by the flamingdangerzone contributors
+//
+// To the extent possible under law, the author(s) have dedicated all copyright and related
+// and neighboring rights to this software to the public domain worldwide. This software is
+// distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along with this software.
+// If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+//
+// Fills a vector with flag-heavy records, as a my::tuple and as a my::packed_tuple of the same
+// fields, and times a scan that filters on the flags and sums a column.
+//
+//     g++ -std=c++11 -O2 -o packed_bench packed_bench.c++ && ./packed_bench [count] [passes]
+
+#include "tuple.h++"
+#include "packed_tuple.h++"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+    enum class state { idle, queued, running, done, failed };
+
+    using plain_record = my::tuple<std::uint32_t, bool, bool, bool, bool, bool, bool, state, std::uint8_t, std::uint16_t>;
+    using packed_record = my::packed_tuple<std::uint32_t, my::bits<1, bool>, my::bits<1, bool>, my::bits<1, bool>,
+                                           my::bits<1, bool>, my::bits<1, bool>, my::bits<1, bool>, my::bits<3, state>,
+                                           my::bits<4, std::uint8_t>, my::bits<10, std::uint16_t>>;
+
+    // keep the optimizer from dropping the work
+    volatile std::uint64_t sink;
+
+    template <typename Function>
+    double seconds(Function f) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template <typename Record>
+    Record make_record(std::uint64_t seed) {
+        return Record(std::uint32_t(seed), seed & 1, seed >> 1 & 1, seed >> 2 & 1, seed >> 3 & 1, seed >> 4 & 1,
+                      seed >> 5 & 1, state(seed >> 6 & 3), std::uint8_t(seed >> 8 & 15), std::uint16_t(seed >> 12 & 1023));
+    }
+
+    template <typename Record>
+    std::uint64_t scan(std::vector<Record> const& records) {
+        std::uint64_t total = 0;
+        for(auto const& r : records) {
+            if(my::get<1>(r) && !my::get<3>(r) && my::get<7>(r) == state::running && my::get<8>(r) > 7) {
+                total += my::get<0>(r) + my::get<9>(r);
+            }
+        }
+        return total;
+    }
+
+    template <typename Record>
+    void run(char const* name, std::vector<std::uint64_t> const& seeds, int passes) {
+        std::vector<Record> records;
+        records.reserve(seeds.size());
+        for(auto seed : seeds) records.push_back(make_record<Record>(seed));
+
+        std::uint64_t total = 0;
+        double time = seconds([&] { for(int i = 0; i < passes; ++i) total += scan(records); });
+        sink = total;
+
+        double scanned = double(records.size()) * passes;
+        std::printf("%-12s %8zu %10zu %10.3f %10.1f\n",
+                    name, sizeof(Record), 64 / sizeof(Record), time, scanned / time / 1e6);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    int passes = argc > 2? std::atoi(argv[2]) : 10;
+    std::mt19937_64 random(42);
+    std::vector<std::uint64_t> seeds(count);
+    for(auto& s : seeds) s = random();
+
+    std::printf("%zu records, %d passes\n", count, passes);
+    std::printf("%-12s %8s %10s %10s %10s\n", "", "sizeof", "per line", "seconds", "M/s");
+    run<plain_record>("tuple", seeds, passes);
+    run<packed_record>("packed_tuple", seeds, passes);
+}
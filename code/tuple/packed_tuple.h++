@@ -0,0 +1,362 @@
+// Bit-packed optimal layout tuple
+//
+// Written in 2026 by the flamingdangerzone contributors
+//
+// To the extent possible under law, the author(s) have dedicated all copyright and related
+// and neighboring rights to this software to the public domain worldwide. This software is
+// distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along with this software.
+// If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+#ifndef MY_PACKED_TUPLE_HPP
+#define MY_PACKED_TUPLE_HPP
+
+#include "tuple.h++"
+
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace my {
+    // annotation for elements that only need the N lowest bits of a bool, enum or integer
+    template <std::size_t N, typename T>
+    struct bits;
+
+    template <typename T>
+    struct is_packed : Bool<false> {};
+    template <std::size_t N, typename T>
+    struct is_packed<bits<N, T>> : Bool<true> {};
+    template <typename T>
+    struct is_unpacked : Bool<!is_packed<T>::value> {};
+
+    template <typename T>
+    struct bit_width : index<0> {};
+    template <std::size_t N, typename T>
+    struct bit_width<bits<N, T>> : index<N> {};
+
+    template <typename T>
+    struct unpacked : identity<T> {};
+    template <std::size_t N, typename T>
+    struct unpacked<bits<N, T>> : identity<T> {};
+    template <typename T>
+    using Unpacked = typename unpacked<T>::type;
+
+    // the integer that a packed element is stored as
+    template <typename T, bool Enum = std::is_enum<T>::value>
+    struct bit_value : identity<T> {};
+    template <typename T>
+    struct bit_value<T, true> : identity<typename std::underlying_type<T>::type> {};
+    template <typename T>
+    using BitValue = typename bit_value<T>::type;
+
+    // A field, plus its offset within its first byte, has to fit in one 64-bit word.
+    constexpr std::size_t max_bit_width = 56;
+
+    template <typename T>
+    struct valid_bits : Bool<true> {};
+    template <std::size_t N, typename T>
+    struct valid_bits<bits<N, T>>
+    : Bool<(std::is_integral<T>::value || std::is_enum<T>::value)
+           && 0 < N && N <= max_bit_width
+           && N <= std::size_t(std::numeric_limits<BitValue<T>>::digits + std::is_signed<BitValue<T>>::value)> {};
+
+    // The packed elements share a block of bytes. Fields go one after the other in interface
+    // order, without gaps, and are read and written a byte range at a time. Bits that belong
+    // to no field are always zero, so blocks compare and hash as plain bytes.
+    template <std::size_t Bytes>
+    struct bit_block {
+        unsigned char bytes[Bytes];
+
+        template <std::size_t Offset, std::size_t Width>
+        std::uint64_t load() const noexcept {
+            std::uint64_t word = 0;
+            for(std::size_t i = 0; i < covered<Offset, Width>(); ++i) {
+                word |= std::uint64_t(bytes[Offset / 8 + i]) << (8 * i);
+            }
+            return (word >> (Offset % 8)) & mask<Width>();
+        }
+        template <std::size_t Offset, std::size_t Width>
+        void store(std::uint64_t value) noexcept {
+            std::uint64_t word = 0;
+            for(std::size_t i = 0; i < covered<Offset, Width>(); ++i) {
+                word |= std::uint64_t(bytes[Offset / 8 + i]) << (8 * i);
+            }
+            word &= ~(mask<Width>() << (Offset % 8));
+            word |= (value & mask<Width>()) << (Offset % 8);
+            for(std::size_t i = 0; i < covered<Offset, Width>(); ++i) {
+                bytes[Offset / 8 + i] = static_cast<unsigned char>(word >> (8 * i));
+            }
+        }
+
+        friend bool operator==(bit_block const& a, bit_block const& b) noexcept {
+            return std::memcmp(a.bytes, b.bytes, Bytes) == 0;
+        }
+        friend bool operator!=(bit_block const& a, bit_block const& b) noexcept {
+            return !(a == b);
+        }
+
+    private:
+        // how many bytes a field touches
+        template <std::size_t Offset, std::size_t Width>
+        static constexpr std::size_t covered() noexcept {
+            return (Offset % 8 + Width + 7) / 8;
+        }
+        template <std::size_t Width>
+        static constexpr std::uint64_t mask() noexcept {
+            return ~std::uint64_t(0) >> (64 - Width);
+        }
+    };
+    // no packed elements, no space
+    template <>
+    struct bit_block<0> {
+        friend bool operator==(bit_block const&, bit_block const&) noexcept { return true; }
+        friend bool operator!=(bit_block const&, bit_block const&) noexcept { return false; }
+    };
+
+    template <std::size_t Bytes>
+    struct is_bitwise_comparable<bit_block<Bytes>> : Bool<true> {};
+
+    // converting between values and their bits; signed integers are sign-extended back, but
+    // enums are not, so that bits<2, E> holds enumerators 0 to 3 whatever the underlying type
+    template <typename T>
+    std::uint64_t encode_bits(T value) noexcept {
+        return static_cast<std::uint64_t>(static_cast<BitValue<T>>(value));
+    }
+    template <typename T, std::size_t Width>
+    T decode_bits(std::uint64_t bits) noexcept {
+        using value_type = BitValue<T>;
+        constexpr bool extend = std::is_signed<T>::value;
+        constexpr std::uint64_t sign = extend? std::uint64_t(1) << (Width - 1) : 0;
+        return static_cast<T>(static_cast<value_type>((bits ^ sign) - sign));
+    }
+
+    // proxy for a packed element, like std::vector<bool>::reference
+    template <typename T, std::size_t Offset, std::size_t Width, std::size_t Bytes>
+    struct bit_reference {
+        explicit bit_reference(bit_block<Bytes>& block) noexcept : block(block) {}
+        bit_reference(bit_reference const&) = default;
+
+        operator T() const noexcept {
+            return decode_bits<T, Width>(block.template load<Offset, Width>());
+        }
+        bit_reference& operator=(T value) noexcept {
+            block.template store<Offset, Width>(encode_bits(value));
+            return *this;
+        }
+        bit_reference& operator=(bit_reference const& that) noexcept {
+            return *this = T(that);
+        }
+
+    private:
+        bit_block<Bytes>& block;
+    };
+
+    // where each element of a packed_tuple goes: the bit offsets of the packed elements, and
+    // the positions of the others in the inner tuple
+    template <typename List, typename Positions = IndicesFor<List>>
+    struct packed_fields;
+    template <typename... T, std::size_t... J>
+    struct packed_fields<std::tuple<T...>, indices<J...>> {
+    private:
+        using widths = index_array<indices<bit_width<T>::value...>>;
+        using plain = index_array<indices<is_unpacked<T>::value...>>;
+
+    public:
+        static constexpr std::size_t bytes = (array_sum(widths::values, 0, sizeof...(T)) + 7) / 8;
+        static constexpr std::size_t block_index = array_sum(plain::values, 0, sizeof...(T));
+
+        template <std::size_t I>
+        using Offset = index<array_sum(widths::values, 0, I)>;
+        template <std::size_t I>
+        using PlainIndex = index<array_sum(plain::values, 0, I)>;
+
+        using plain_positions = Slice<typename stable_order<indices<is_unpacked<T>::value...>>::type, 0, block_index>;
+        using packed_positions = Slice<typename stable_order<indices<is_packed<T>::value...>>::type, 0, sizeof...(T) - block_index>;
+    };
+
+    template <typename T>
+    using PackedValue = Unannotated<Unpacked<T>>;
+
+    // The elements annotated as bits<N, T> share a bit_block, and that block is one more
+    // element of an optimal layout tuple with all the others. Since the block only needs
+    // byte alignment, it goes at the end, together with the chars.
+    template <typename... T>
+    struct packed_tuple {
+    private:
+        static_assert(All<valid_bits<T>...>::value,
+            "bits<N, T> needs a bool, enum or integer T with at least N bits, and N at most 56");
+
+        using fields = packed_fields<std::tuple<T...>>;
+        using block_type = bit_block<fields::bytes>;
+        using tuple_type = typename as_tuple<Concat<Filter<is_unpacked, std::tuple<T...>>, std::tuple<block_type>>>::type;
+
+        template <std::size_t I>
+        using Field = ListElement<I, std::tuple<T...>>;
+        template <std::size_t I>
+        using Value = PackedValue<Field<I>>;
+
+    public:
+        using unpacked_type = tuple<Unpacked<T>...>;
+
+        template <std::size_t I>
+        using reference = Conditional<is_packed<Field<I>>,
+                                      bit_reference<Value<I>, fields::template Offset<I>::value, bit_width<Field<I>>::value, fields::bytes>,
+                                      Value<I>&>;
+        template <std::size_t I>
+        using const_reference = Conditional<is_packed<Field<I>>, Value<I>, Value<I> const&>;
+        template <std::size_t I>
+        using rvalue_reference = Conditional<is_packed<Field<I>>, Value<I>, Value<I>&&>;
+
+        constexpr packed_tuple() = default;
+
+        explicit packed_tuple(PackedValue<T> const&... t)
+        : packed_tuple(std::piecewise_construct, std::forward_as_tuple(t...)) {}
+
+        template <typename... U>
+        explicit packed_tuple(tuple<U...> const& t)
+        : packed_tuple(std::piecewise_construct, forward_shuffled_tuple(IndicesFor<std::tuple<T...>>{}, t)) {
+            static_assert(sizeof...(T) == sizeof...(U),
+                "source tuple size must match destination tuple size");
+        }
+        template <typename... U>
+        explicit packed_tuple(tuple<U...>&& t)
+        : packed_tuple(std::piecewise_construct, forward_shuffled_tuple(IndicesFor<std::tuple<T...>>{}, std::move(t))) {
+            static_assert(sizeof...(T) == sizeof...(U),
+                "source tuple size must match destination tuple size");
+        }
+
+        void swap(packed_tuple& that)
+        noexcept(noexcept(std::declval<tuple_type&>().swap(std::declval<tuple_type&>()))) {
+            elements.swap(that.elements);
+        }
+
+    private:
+        tuple_type elements;
+
+        // from references to all the elements, in interface order
+        template <typename Refs>
+        packed_tuple(std::piecewise_construct_t, Refs&& refs)
+        : packed_tuple(std::forward<Refs>(refs), typename fields::plain_positions{}) {}
+        template <typename Refs, std::size_t... P>
+        packed_tuple(Refs&& refs, indices<P...>)
+        : elements(std::get<P>(std::forward<Refs>(refs))..., pack(refs, typename fields::packed_positions{})) {}
+
+        template <typename Refs, std::size_t... Q>
+        static block_type pack(Refs& refs, indices<Q...>) noexcept {
+            block_type block {};
+            (void)swallow{ 0, (store<Q>(block, std::get<Q>(refs)), 0)... };
+            return block;
+        }
+        template <std::size_t I>
+        static void store(block_type& block, Value<I> value) noexcept {
+            block.template store<fields::template Offset<I>::value, bit_width<Field<I>>::value>(
+                encode_bits(value));
+        }
+        template <std::size_t I>
+        static Value<I> load(block_type const& block) noexcept {
+            return decode_bits<Value<I>, bit_width<Field<I>>::value>(
+                block.template load<fields::template Offset<I>::value, bit_width<Field<I>>::value>());
+        }
+
+        block_type& block() noexcept {
+            return my::get<fields::block_index>(elements);
+        }
+        block_type const& block() const noexcept {
+            return my::get<fields::block_index>(elements);
+        }
+
+        template <std::size_t I>
+        reference<I> at(Bool<true>) noexcept {
+            return reference<I>(block());
+        }
+        template <std::size_t I>
+        reference<I> at(Bool<false>) noexcept {
+            return my::get<fields::template PlainIndex<I>::value>(elements);
+        }
+        template <std::size_t I>
+        const_reference<I> at(Bool<true>) const noexcept {
+            return load<I>(block());
+        }
+        template <std::size_t I>
+        const_reference<I> at(Bool<false>) const noexcept {
+            return my::get<fields::template PlainIndex<I>::value>(elements);
+        }
+
+        // the block is read once, and every packed element is taken from that copy
+        template <std::size_t I>
+        static const_reference<I> unpack_element(packed_tuple const& p, block_type const&, Bool<false>) {
+            return p.at<I>(Bool<false>{});
+        }
+        template <std::size_t I>
+        static const_reference<I> unpack_element(packed_tuple const&, block_type const& block, Bool<true>) {
+            return load<I>(block);
+        }
+        template <std::size_t... I>
+        unpacked_type unpack(indices<I...>) const {
+            block_type const copy = block();
+            return unpacked_type(unpack_element<I>(*this, copy, is_packed<Field<I>>{})...);
+        }
+
+        template <std::size_t I, typename... U>
+        friend typename packed_tuple<U...>::template reference<I> get(packed_tuple<U...>& p) noexcept;
+        template <std::size_t I, typename... U>
+        friend typename packed_tuple<U...>::template const_reference<I> get(packed_tuple<U...> const& p) noexcept;
+        template <std::size_t I, typename... U>
+        friend typename packed_tuple<U...>::template rvalue_reference<I> get(packed_tuple<U...>&& p) noexcept;
+        template <typename... U>
+        friend tuple<Unpacked<U>...> unpack(packed_tuple<U...> const& p);
+        template <typename... U>
+        friend bool operator==(packed_tuple<U...> const& p, packed_tuple<U...> const& q);
+    };
+
+    template <std::size_t I, typename... U>
+    typename packed_tuple<U...>::template reference<I> get(packed_tuple<U...>& p) noexcept {
+        return p.template at<I>(is_packed<ListElement<I, std::tuple<U...>>>{});
+    }
+    template <std::size_t I, typename... U>
+    typename packed_tuple<U...>::template const_reference<I> get(packed_tuple<U...> const& p) noexcept {
+        return p.template at<I>(is_packed<ListElement<I, std::tuple<U...>>>{});
+    }
+    template <std::size_t I, typename... U>
+    typename packed_tuple<U...>::template rvalue_reference<I> get(packed_tuple<U...>&& p) noexcept {
+        using result_type = typename packed_tuple<U...>::template rvalue_reference<I>;
+        return static_cast<result_type>(p.template at<I>(is_packed<ListElement<I, std::tuple<U...>>>{}));
+    }
+
+    // all the elements at once, into a plain tuple
+    template <typename... T>
+    tuple<Unpacked<T>...> unpack(packed_tuple<T...> const& p) {
+        return p.unpack(IndicesFor<std::tuple<T...>>{});
+    }
+
+    template <typename... T>
+    bool operator==(packed_tuple<T...> const& p, packed_tuple<T...> const& q) {
+        return p.elements == q.elements;
+    }
+    template <typename... T>
+    bool operator!=(packed_tuple<T...> const& p, packed_tuple<T...> const& q) {
+        return !(p == q);
+    }
+
+    template <typename... T>
+    void swap(packed_tuple<T...>& x, packed_tuple<T...>& y) noexcept(noexcept(x.swap(y))) {
+        x.swap(y);
+    }
+} // namespace my
+
+namespace std {
+    template <typename... T>
+    struct tuple_size< ::my::packed_tuple<T...>> : integral_constant<size_t, sizeof...(T)> {};
+
+    template <size_t I, typename... T>
+    struct tuple_element<I, ::my::packed_tuple<T...>>
+    : ::my::identity< ::my::PackedValue< ::my::ListElement<I, ::std::tuple<T...>>>> {};
+} // namespace std
+
+#endif // MY_PACKED_TUPLE_HPP
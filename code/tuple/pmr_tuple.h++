@@ -0,0 +1,193 @@
+// Optimal layout tuples with polymorphic memory resources
+//
+// Written in 2026 by the flamingdangerzone contributors
+//
+// To the extent possible under law, the author(s) have dedicated all copyright and related
+// and neighboring rights to this software to the public domain worldwide. This software is
+// distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along with this software.
+// If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+#ifndef MY_PMR_TUPLE_HPP
+#define MY_PMR_TUPLE_HPP
+
+#include "tuple.h++"
+
+// needs C++17 and a standard library that has memory resources
+#if __cplusplus >= 201703L && defined(__has_include)
+#  if __has_include(<memory_resource>)
+#    define MY_TUPLE_PMR
+#  endif
+#endif
+
+#if defined(MY_TUPLE_PMR)
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+
+namespace my {
+    namespace pmr {
+        // The element types that allocate, switched over to polymorphic allocators. Strings,
+        // vectors and nested tuples are covered; specialize for other allocator-aware types.
+        template <typename T>
+        struct pmr_type : identity<T> {};
+        template <typename T>
+        using PmrType = typename pmr_type<T>::type;
+
+        template <typename C, typename Traits>
+        struct pmr_type<std::basic_string<C, Traits, std::allocator<C>>> : identity<std::pmr::basic_string<C, Traits>> {};
+        template <typename T>
+        struct pmr_type<std::vector<T, std::allocator<T>>> : identity<std::pmr::vector<PmrType<T>>> {};
+        template <typename... T>
+        struct pmr_type<my::tuple<T...>> : identity<my::tuple<PmrType<T>...>> {};
+        template <typename T>
+        struct pmr_type<hot<T>> : identity<hot<PmrType<T>>> {};
+
+        // Constructed with std::allocator_arg and a polymorphic allocator, every element that
+        // uses allocators gets the same memory resource.
+        template <typename... T>
+        using tuple = my::tuple<PmrType<T>...>;
+
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+        struct allocation_stats {
+            std::size_t allocations = 0;
+            std::size_t deallocations = 0;
+            std::size_t bytes_allocated = 0;
+            std::size_t bytes_in_use = 0;
+        };
+
+        // counts what goes through to another resource
+        struct counting_resource : std::pmr::memory_resource {
+            explicit counting_resource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+            : upstream(upstream) {}
+
+            counting_resource(counting_resource const&) = delete;
+            counting_resource& operator=(counting_resource const&) = delete;
+
+            allocation_stats const& stats() const noexcept { return counts; }
+            void reset_stats() noexcept { counts = allocation_stats{}; }
+
+        private:
+            std::pmr::memory_resource* upstream;
+            allocation_stats counts;
+
+            void* do_allocate(std::size_t bytes, std::size_t align) override {
+                void* p = upstream->allocate(bytes, align);
+                ++counts.allocations;
+                counts.bytes_allocated += bytes;
+                counts.bytes_in_use += bytes;
+                return p;
+            }
+            void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+                upstream->deallocate(p, bytes, align);
+                ++counts.deallocations;
+                counts.bytes_in_use -= bytes;
+            }
+            bool do_is_equal(std::pmr::memory_resource const& that) const noexcept override {
+                return this == &that;
+            }
+        };
+
+        // Tuples and everything they own, built in one region and released all at once. The
+        // tuples go in blocks taken from the region, and the elements allocate from it too, so
+        // the upstream resource only sees a few large requests. Releasing runs the destructors,
+        // which give nothing back upstream, and then hands the whole region back.
+        template <typename Resource, typename... T>
+        struct basic_tuple_arena {
+            using value_type = tuple<T...>;
+            using size_type = std::size_t;
+
+            explicit basic_tuple_arena(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : upstream_counter(upstream), region(&upstream_counter), counter(&region),
+              blocks(nullptr), count(0) {}
+
+            basic_tuple_arena(basic_tuple_arena const&) = delete;
+            basic_tuple_arena& operator=(basic_tuple_arena const&) = delete;
+
+            ~basic_tuple_arena() {
+                release();
+            }
+
+            template <typename... U>
+            value_type& emplace(U&&... u) {
+                if(!blocks || blocks->count == blocks->capacity) add_block();
+                value_type* p = blocks->data() + blocks->count;
+                ::new(static_cast<void*>(p)) value_type(std::allocator_arg, get_allocator(), std::forward<U>(u)...);
+                ++blocks->count;
+                ++count;
+                return *p;
+            }
+
+            size_type size() const noexcept { return count; }
+            bool empty() const noexcept { return count == 0; }
+
+            allocator_type get_allocator() noexcept { return allocator_type(&counter); }
+            std::pmr::memory_resource* resource() noexcept { return &counter; }
+
+            // what the tuples and their elements asked the arena for
+            allocation_stats const& stats() const noexcept { return counter.stats(); }
+            // what the arena asked the upstream resource for
+            allocation_stats const& upstream_stats() const noexcept { return upstream_counter.stats(); }
+
+            void release() noexcept {
+                if(!std::is_trivially_destructible<value_type>::value) {
+                    for(block* b = blocks; b; b = b->next) {
+                        for(size_type i = 0; i != b->count; ++i) b->data()[i].~value_type();
+                    }
+                }
+                blocks = nullptr;
+                count = 0;
+                region.release();
+            }
+
+        private:
+            struct block {
+                block* next;
+                size_type count;
+                size_type capacity;
+
+                static constexpr std::size_t header_size = RoundUp<sizeof(block*) + 2 * sizeof(size_type), alignof(value_type)>::value;
+                value_type* data() noexcept {
+                    return reinterpret_cast<value_type*>(reinterpret_cast<unsigned char*>(this) + header_size);
+                }
+            };
+
+            static constexpr size_type first_block = 16;
+            static constexpr size_type largest_block = 4096;
+
+            counting_resource upstream_counter;
+            Resource region;
+            counting_resource counter;
+            block* blocks;
+            size_type count;
+
+            void add_block() {
+                size_type capacity = !blocks? first_block
+                                   : blocks->capacity < largest_block? 2 * blocks->capacity
+                                   : largest_block;
+                auto align = alignof(value_type) < alignof(block)? alignof(block) : alignof(value_type);
+                void* p = region.allocate(block::header_size + capacity * sizeof(value_type), align);
+                blocks = ::new(p) block { blocks, 0, capacity };
+            }
+        };
+
+        // bump allocation; nothing is reused until release
+        template <typename... T>
+        using tuple_arena = basic_tuple_arena<std::pmr::monotonic_buffer_resource, T...>;
+        // size-class pools, for batches where elements come and go
+        template <typename... T>
+        using pool_tuple_arena = basic_tuple_arena<std::pmr::unsynchronized_pool_resource, T...>;
+    } // namespace pmr
+} // namespace my
+#endif
+#undef MY_TUPLE_PMR
+
+#endif // MY_PMR_TUPLE_HPP
@@ -0,0 +1,142 @@
+// Trivial relocation for optimal layout tuples
+//
+// Written in 2026 by the flamingdangerzone contributors
+//
+// To the extent possible under law, the author(s) have dedicated all copyright and related
+// and neighboring rights to this software to the public domain worldwide. This software is
+// distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along with this software.
+// If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+#ifndef MY_RELOCATE_HPP
+#define MY_RELOCATE_HPP
+
+#include "tuple.h++"
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <cstddef>
+#include <cstring>
+
+namespace my {
+    // Relocating an object is moving it to a new address and destroying the old one. For
+    // trivially relocatable types that is the same as copying the bytes and forgetting about
+    // the source. Trivially copyable types are; specialize for others that hold no pointers
+    // into themselves and register their address nowhere.
+    template <typename T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+    // references are stored as pointers
+    template <typename T>
+    struct is_trivially_relocatable<T&> : Bool<true> {};
+    template <typename T>
+    struct is_trivially_relocatable<T&&> : Bool<true> {};
+
+    template <typename... T>
+    struct is_trivially_relocatable<tuple<T...>> : All<is_trivially_relocatable<Unannotated<T>>...> {};
+
+    // Smart pointers are plain pointers underneath everywhere. std::string is left out: some
+    // implementations point into the object for short strings.
+    template <typename T>
+    struct is_trivially_relocatable<std::unique_ptr<T>> : Bool<true> {};
+    template <typename T>
+    struct is_trivially_relocatable<std::unique_ptr<T[]>> : Bool<true> {};
+    template <typename T>
+    struct is_trivially_relocatable<std::shared_ptr<T>> : Bool<true> {};
+    template <typename T>
+    struct is_trivially_relocatable<std::weak_ptr<T>> : Bool<true> {};
+
+    template <typename T>
+    struct is_relocatable
+    : Bool<is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value> {};
+
+    // Relocates [first, last) into uninitialized storage at d_first; the ranges do not overlap.
+    // If a move throws, what was already built is destroyed and the source is left as it was;
+    // types that cannot be moved without throwing are copied instead.
+    template <typename T>
+    T* uninitialized_relocate(T* first, T* last, T* d_first, Bool<true>) noexcept {
+        if(first != last) std::memcpy(static_cast<void*>(d_first), static_cast<void const*>(first), (last - first) * sizeof(T));
+        return d_first + (last - first);
+    }
+    template <typename T>
+    T* uninitialized_relocate(T* first, T* last, T* d_first, Bool<false>) {
+        T* d = d_first;
+        try {
+            for(T* p = first; p != last; ++p, ++d) {
+                ::new(static_cast<void*>(d)) T(std::move_if_noexcept(*p));
+            }
+        } catch(...) {
+            for(; d != d_first; --d) (d - 1)->~T();
+            throw;
+        }
+        for(; first != last; ++first) first->~T();
+        return d;
+    }
+    template <typename T>
+    T* uninitialized_relocate(T* first, T* last, T* d_first) {
+        return my::uninitialized_relocate(first, last, d_first, is_trivially_relocatable<T>{});
+    }
+
+    // Relocates n objects from first to d_first, where the ranges may overlap; whatever part
+    // of the destination is not in the source must be uninitialized. Shifting elements inside
+    // a buffer is one memmove when the type is trivially relocatable.
+    template <typename T>
+    void relocate_one(T* from, T* to) noexcept {
+        ::new(static_cast<void*>(to)) T(std::move(*from));
+        from->~T();
+    }
+    template <typename T>
+    T* relocate_n(T* first, std::size_t n, T* d_first, Bool<true>) noexcept {
+        if(n != 0) std::memmove(static_cast<void*>(d_first), static_cast<void const*>(first), n * sizeof(T));
+        return d_first + n;
+    }
+    template <typename T>
+    T* relocate_n(T* first, std::size_t n, T* d_first, Bool<false>) noexcept {
+        if(d_first < first) {
+            for(std::size_t i = 0; i != n; ++i) my::relocate_one(first + i, d_first + i);
+        } else if(first < d_first) {
+            for(std::size_t i = n; i != 0; --i) my::relocate_one(first + i - 1, d_first + i - 1);
+        }
+        return d_first + n;
+    }
+    template <typename T>
+    T* relocate_n(T* first, std::size_t n, T* d_first) noexcept {
+        static_assert(is_relocatable<T>::value,
+            "relocating within a buffer needs trivially relocatable or nothrow movable elements");
+        return my::relocate_n(first, n, d_first, is_trivially_relocatable<T>{});
+    }
+
+    // Swaps [first1, last1) with the range at first2; they do not overlap. Trivially
+    // relocatable elements are swapped by bytes, a block at a time.
+    constexpr std::size_t swap_block_size = 256;
+    template <typename T>
+    T* swap_ranges(T* first1, T* last1, T* first2, Bool<true>) noexcept {
+        auto a = reinterpret_cast<unsigned char*>(first1);
+        auto b = reinterpret_cast<unsigned char*>(first2);
+        std::size_t n = (last1 - first1) * sizeof(T);
+        unsigned char buffer[swap_block_size];
+        for(std::size_t done = 0; done < n; done += swap_block_size) {
+            std::size_t chunk = n - done < swap_block_size? n - done : swap_block_size;
+            std::memcpy(buffer, a + done, chunk);
+            std::memcpy(a + done, b + done, chunk);
+            std::memcpy(b + done, buffer, chunk);
+        }
+        return first2 + (last1 - first1);
+    }
+    template <typename T>
+    T* swap_ranges(T* first1, T* last1, T* first2, Bool<false>) {
+        using std::swap;
+        for(; first1 != last1; ++first1, ++first2) swap(*first1, *first2);
+        return first2;
+    }
+    template <typename T>
+    T* swap_ranges(T* first1, T* last1, T* first2)
+    noexcept(is_trivially_relocatable<T>::value || is_nothrow_swappable<T>::value) {
+        return my::swap_ranges(first1, last1, first2, is_trivially_relocatable<T>{});
+    }
+} // namespace my
+
+#endif // MY_RELOCATE_HPP
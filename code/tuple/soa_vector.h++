@@ -0,0 +1,402 @@
+// Columnar container of optimal layout tuples
+//
+// Written in 2026 by the flamingdangerzone contributors
+//
+// To the extent possible under law, the author(s) have dedicated all copyright and related
+// and neighboring rights to this software to the public domain worldwide. This software is
+// distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along with this software.
+// If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+#ifndef MY_SOA_VECTOR_HPP
+#define MY_SOA_VECTOR_HPP
+
+#include "tuple.h++"
+
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <cstddef>
+
+namespace my {
+    // contiguous view of a single column
+    template <typename T>
+    struct span {
+        using value_type = typename std::remove_const<T>::type;
+        using iterator = T*;
+
+        constexpr span() : first(nullptr), count(0) {}
+        constexpr span(T* first, std::size_t count) : first(first), count(count) {}
+
+        constexpr T* data() const { return first; }
+        constexpr std::size_t size() const { return count; }
+        constexpr bool empty() const { return count == 0; }
+
+        constexpr T* begin() const { return first; }
+        constexpr T* end() const { return first + count; }
+
+        constexpr T& operator[](std::size_t i) const { return first[i]; }
+
+    private:
+        T* first;
+        std::size_t count;
+    };
+
+    // sum of the sizes of the first N elements of a list
+    template <std::size_t N, typename List, typename Indices = IndicesFor<List>>
+    struct prefix_size;
+    template <std::size_t N, typename... T, std::size_t... I>
+    struct prefix_size<N, std::tuple<T...>, indices<I...>>
+    : sum<((I < N)? sizeof(T) : 0)...> {};
+
+    // All columns live in a single block, one after the other, by decreasing alignment. Since
+    // sizes are multiples of alignments, every column starts suitably aligned without any
+    // padding between them. That is the default storage order of the tuple too, but the
+    // columns keep it whatever layout policy the tuple uses.
+    template <typename... T>
+    struct soa_vector {
+    private:
+        static_assert(sizeof...(T) > 0, "soa_vector needs at least one column");
+        static_assert(All<Bool<!std::is_reference<Unannotated<T>>::value>...>::value,
+            "columns cannot hold references");
+
+        using columns = std::tuple<Unannotated<T>...>;
+        using order = optimal_order<columns, by_alignment>;
+        using storage_type = typename order::tuple;
+        using to_storage = typename order::to_storage;
+        using interface_indices = IndicesFor<columns>;
+        using storage_indices = IndicesFor<storage_type>;
+
+        template <std::size_t I>
+        using Column = TupleElement<I, columns>;
+        template <std::size_t I>
+        using ToStorageIndex = TupleElement<I, to_storage>;
+
+        static constexpr std::size_t block_align = max<alignof(Unannotated<T>)...>::value;
+        using block_unit = layout<block_align>;
+
+        template <bool Const>
+        struct basic_iterator;
+
+    public:
+        using value_type = tuple<T...>;
+        using reference = tuple<Unannotated<T>&...>;
+        using const_reference = tuple<Unannotated<T> const&...>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+
+        soa_vector() noexcept : block(nullptr), count(0), cap(0) {}
+
+        soa_vector(soa_vector const& that) : soa_vector() {
+            reserve(that.count);
+            for(auto&& row : that) push_back(row);
+        }
+        soa_vector(soa_vector&& that) noexcept : soa_vector() {
+            swap(that);
+        }
+
+        soa_vector& operator=(soa_vector that) noexcept {
+            swap(that);
+            return *this;
+        }
+
+        ~soa_vector() {
+            clear();
+            deallocate(block, cap);
+        }
+
+        void swap(soa_vector& that) noexcept {
+            using std::swap;
+            swap(block, that.block);
+            swap(count, that.count);
+            swap(cap, that.cap);
+        }
+
+        size_type size() const noexcept { return count; }
+        size_type capacity() const noexcept { return cap; }
+        bool empty() const noexcept { return count == 0; }
+
+        template <std::size_t I>
+        span<Column<I>> column() noexcept {
+            return { column_data<ToStorageIndex<I>::value>(), count };
+        }
+        template <std::size_t I>
+        span<Column<I> const> column() const noexcept {
+            return { column_data<ToStorageIndex<I>::value>(), count };
+        }
+
+        reference operator[](size_type i) noexcept {
+            return row(interface_indices{}, i);
+        }
+        const_reference operator[](size_type i) const noexcept {
+            return row(interface_indices{}, i);
+        }
+
+        reference front() noexcept { return (*this)[0]; }
+        const_reference front() const noexcept { return (*this)[0]; }
+        reference back() noexcept { return (*this)[count-1]; }
+        const_reference back() const noexcept { return (*this)[count-1]; }
+
+        iterator begin() noexcept { return { this, 0 }; }
+        iterator end() noexcept { return { this, count }; }
+        const_iterator begin() const noexcept { return { this, 0 }; }
+        const_iterator end() const noexcept { return { this, count }; }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        void reserve(size_type n) {
+            if(n > cap) reallocate(n);
+        }
+
+        void push_back(value_type const& t) {
+            emplace_from_tuple(interface_indices{}, t);
+        }
+        void push_back(value_type&& t) {
+            emplace_from_tuple(interface_indices{}, std::move(t));
+        }
+        template <typename... U,
+                  EnableIf<Bool<sizeof...(U) == sizeof...(T)>>...>
+        void push_back(tuple<U...> const& t) {
+            emplace_from_tuple(interface_indices{}, t);
+        }
+        template <typename... U,
+                  EnableIf<Bool<sizeof...(U) == sizeof...(T)>>...>
+        void push_back(tuple<U...>&& t) {
+            emplace_from_tuple(interface_indices{}, std::move(t));
+        }
+
+        template <typename... U>
+        void emplace_back(U&&... u) {
+            static_assert(sizeof...(T) == sizeof...(U),
+                "number of arguments must match number of columns");
+            emplace_row(std::forward<U>(u)...);
+        }
+        template <typename... U,
+                  EnableIf<Bool<sizeof...(U) == sizeof...(T)>>...>
+        void emplace_back(tuple<U...>&& t) {
+            emplace_from_tuple(interface_indices{}, std::move(t));
+        }
+
+        void pop_back() noexcept {
+            --count;
+            destroy_rows(storage_indices{}, count, count+1);
+        }
+
+        void clear() noexcept {
+            destroy_rows(storage_indices{}, 0, count);
+            count = 0;
+        }
+
+    private:
+        block_unit* block;
+        size_type count;
+        size_type cap;
+
+        template <std::size_t S>
+        using StorageElement = TupleElement<S, storage_type>;
+
+        static constexpr std::size_t block_units(size_type n) {
+            return (n * sum<sizeof(Unannotated<T>)...>::value + block_align - 1) / block_align;
+        }
+        static block_unit* allocate(size_type n) {
+            return std::allocator<block_unit>{}.allocate(block_units(n));
+        }
+        static void deallocate(block_unit* p, size_type n) noexcept {
+            if(p) std::allocator<block_unit>{}.deallocate(p, block_units(n));
+        }
+
+        template <std::size_t S>
+        static StorageElement<S>* column_data(block_unit* b, size_type n) noexcept {
+            auto bytes = reinterpret_cast<unsigned char*>(b);
+            return reinterpret_cast<StorageElement<S>*>(bytes + n * prefix_size<S, storage_type>::value);
+        }
+        template <std::size_t S>
+        StorageElement<S>* column_data() const noexcept {
+            return column_data<S>(block, cap);
+        }
+
+        template <std::size_t... I>
+        reference row(indices<I...>, size_type i) const noexcept {
+            return reference { column_data<ToStorageIndex<I>::value>()[i]... };
+        }
+
+        size_type grow_size() const noexcept {
+            return cap == 0? 8 : 2*cap;
+        }
+
+        template <typename... U>
+        void emplace_row(U&&... u) {
+            if(count == cap) return grow_and_emplace_row(std::forward<U>(u)...);
+            construct_row(interface_indices{}, block, cap, std::forward<U>(u)...);
+            ++count;
+        }
+        template <std::size_t... I, typename Tuple>
+        void emplace_from_tuple(indices<I...>, Tuple&& t) {
+            emplace_row(get<I>(std::forward<Tuple>(t))...);
+        }
+
+        // the new row is built before the old ones move, since the arguments may refer to them
+        template <typename... U>
+        void grow_and_emplace_row(U&&... u) {
+            size_type n = grow_size();
+            auto fresh = allocate(n);
+            try {
+                construct_row(interface_indices{}, fresh, n, std::forward<U>(u)...);
+            } catch(...) {
+                deallocate(fresh, n);
+                throw;
+            }
+            try {
+                relocate_columns(storage_indices{}, fresh, n);
+            } catch(...) {
+                destroy_row(interface_indices{}, fresh, n);
+                deallocate(fresh, n);
+                throw;
+            }
+            destroy_rows(storage_indices{}, 0, count);
+            deallocate(block, cap);
+            block = fresh;
+            cap = n;
+            ++count;
+        }
+
+        // constructs the elements of the row after the last one in a block, undoing the partial
+        // work if any of them throws
+        template <std::size_t... I, typename... U>
+        void construct_row(indices<I...>, block_unit* b, size_type n, U&&... u) {
+            std::size_t done = 0;
+            try {
+                (void)swallow{ 0, (construct_at<I>(b, n, std::forward<U>(u)), ++done, 0)... };
+            } catch(...) {
+                (void)swallow{ 0, (I < done? destroy_at<I>(b, n) : void(), 0)... };
+                throw;
+            }
+        }
+        template <std::size_t... I>
+        void destroy_row(indices<I...>, block_unit* b, size_type n) noexcept {
+            (void)swallow{ 0, (destroy_at<I>(b, n), 0)... };
+        }
+        template <std::size_t I, typename U>
+        void construct_at(block_unit* b, size_type n, U&& u) {
+            ::new(static_cast<void*>(column_data<ToStorageIndex<I>::value>(b, n) + count))
+                Column<I>(std::forward<U>(u));
+        }
+        template <std::size_t I>
+        void destroy_at(block_unit* b, size_type n) noexcept {
+            column_data<ToStorageIndex<I>::value>(b, n)[count].~Column<I>();
+        }
+
+        template <std::size_t... S>
+        void destroy_rows(indices<S...>, size_type first, size_type last) noexcept {
+            (void)swallow{ 0, (destroy_column<S>(column_data<S>(), first, last), 0)... };
+        }
+        template <std::size_t S>
+        static void destroy_column(StorageElement<S>* p, size_type first, size_type last) noexcept {
+            for(; first != last; ++first) p[first].~StorageElement<S>();
+        }
+
+        void reallocate(size_type n) {
+            auto fresh = allocate(n);
+            try {
+                relocate_columns(storage_indices{}, fresh, n);
+            } catch(...) {
+                deallocate(fresh, n);
+                throw;
+            }
+            destroy_rows(storage_indices{}, 0, count);
+            deallocate(block, cap);
+            block = fresh;
+            cap = n;
+        }
+        // Moves every column into a new block, or copies them all if moving any of them can
+        // throw, so that the old rows are left intact when it does. Columns that cannot be
+        // copied are moved anyway, as std::move_if_noexcept would.
+        static constexpr bool nothrow_move_rows = All<std::is_nothrow_move_constructible<Unannotated<T>>...>::value;
+        template <typename U>
+        using Relocated = Conditional<Bool<nothrow_move_rows || !std::is_copy_constructible<U>::value>, U&&, U const&>;
+
+        template <std::size_t... S>
+        void relocate_columns(indices<S...>, block_unit* fresh, size_type n) {
+            std::size_t done = 0;
+            try {
+                (void)swallow{ 0, (relocate_column<S>(column_data<S>(fresh, n)), ++done, 0)... };
+            } catch(...) {
+                (void)swallow{ 0, (S < done? destroy_column<S>(column_data<S>(fresh, n), 0, count) : void(), 0)... };
+                throw;
+            }
+        }
+        template <std::size_t S>
+        void relocate_column(StorageElement<S>* to) {
+            auto from = column_data<S>();
+            size_type i = 0;
+            try {
+                for(; i != count; ++i) {
+                    ::new(static_cast<void*>(to + i)) StorageElement<S>(static_cast<Relocated<StorageElement<S>>>(from[i]));
+                }
+            } catch(...) {
+                destroy_column<S>(to, 0, i);
+                throw;
+            }
+        }
+    };
+
+    template <typename... T>
+    template <bool Const>
+    struct soa_vector<T...>::basic_iterator {
+        using container = Conditional<Bool<Const>, soa_vector const, soa_vector>;
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = tuple<T...>;
+        using difference_type = std::ptrdiff_t;
+        using reference = Conditional<Bool<Const>, tuple<Unannotated<T> const&...>, tuple<Unannotated<T>&...>>;
+        using pointer = void;
+
+        basic_iterator() noexcept : v(nullptr), i(0) {}
+        basic_iterator(container* v, std::size_t i) noexcept : v(v), i(i) {}
+        template <bool C = Const, EnableIf<Bool<C>>...>
+        basic_iterator(basic_iterator<false> const& that) noexcept : v(that.v), i(that.i) {}
+
+        reference operator*() const noexcept { return (*v)[i]; }
+        reference operator[](difference_type n) const noexcept { return (*v)[i + n]; }
+
+        basic_iterator& operator++() noexcept { ++i; return *this; }
+        basic_iterator& operator--() noexcept { --i; return *this; }
+        basic_iterator operator++(int) noexcept { auto old = *this; ++i; return old; }
+        basic_iterator operator--(int) noexcept { auto old = *this; --i; return old; }
+        basic_iterator& operator+=(difference_type n) noexcept { i += n; return *this; }
+        basic_iterator& operator-=(difference_type n) noexcept { i -= n; return *this; }
+
+        friend basic_iterator operator+(basic_iterator it, difference_type n) noexcept { return it += n; }
+        friend basic_iterator operator+(difference_type n, basic_iterator it) noexcept { return it += n; }
+        friend basic_iterator operator-(basic_iterator it, difference_type n) noexcept { return it -= n; }
+        friend difference_type operator-(basic_iterator const& a, basic_iterator const& b) noexcept {
+            return difference_type(a.i) - difference_type(b.i);
+        }
+
+        friend bool operator==(basic_iterator const& a, basic_iterator const& b) noexcept { return a.i == b.i; }
+        friend bool operator!=(basic_iterator const& a, basic_iterator const& b) noexcept { return a.i != b.i; }
+        friend bool operator<(basic_iterator const& a, basic_iterator const& b) noexcept { return a.i < b.i; }
+        friend bool operator>(basic_iterator const& a, basic_iterator const& b) noexcept { return a.i > b.i; }
+        friend bool operator<=(basic_iterator const& a, basic_iterator const& b) noexcept { return a.i <= b.i; }
+        friend bool operator>=(basic_iterator const& a, basic_iterator const& b) noexcept { return a.i >= b.i; }
+
+    private:
+        container* v;
+        std::size_t i;
+
+        friend struct basic_iterator<true>;
+    };
+
+    template <typename... T>
+    void swap(soa_vector<T...>& x, soa_vector<T...>& y) noexcept {
+        x.swap(y);
+    }
+} // namespace my
+
+#endif // MY_SOA_VECTOR_HPP
@@ -1,16 +1,573 @@
-//#define MY_STD_TUPLE_LAYOUT_REVERSED // fake!
-#ifndef MY_STD_TUPLE_LAYOUT_REVERSED
-#define MY_STD_TUPLE_LAYOUT_STRAIGHT
-#endif
 
 #include "tuple.h++"
+#include "soa_vector.h++"
+#include "packed_tuple.h++"
+#include "tuple_view.h++"
+#include "tuple_vector.h++"
+#include "pmr_tuple.h++"
 
 #include <iostream>
+#include <string>
+#include <unordered_set>
+#include <new>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
 #include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <memory>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <unistd.h>
+#endif
+
+struct empty {};
+// empty, and never equal to anything
+struct weird {};
+bool operator==(weird const&, weird const&) { return false; }
+// an empty type with members of its own
+struct equatable {
+    bool operator==(equatable const&) const { return true; }
+};
+struct blob { char bytes[40]; };
+struct wide { double values[10]; };
+struct counts { int values[20]; };
+struct odd12 { int values[3]; };
+struct alignas(16) w16 { char bytes[16]; };
+
+struct counted {
+    static int copies;
+    static int moves;
+
+    int value;
+
+    counted(int value) : value(value) {}
+    counted(counted const& that) : value(that.value) { ++copies; }
+    counted(counted&& that) : value(that.value) { ++moves; }
+};
+int counted::copies = 0;
+int counted::moves = 0;
+
+// copies throw when told to, and moves may throw too
+struct fragile {
+    static bool fail;
+
+    int value;
+
+    fragile(int value) : value(value) {}
+    fragile(fragile const& that) : value(that.value) { if(fail) throw 0; }
+    fragile(fragile&& that) : value(that.value) {}
+};
+bool fragile::fail = false;
+
+// opts into trivial relocation, and counts the moves that it saves
+struct relocatable : counted {
+    using counted::counted;
+};
+
+// keeps the declaration order, so that alignment can increase along the storage
+struct declaration_order {
+    template <typename List>
+    struct apply : my::identity<List> {};
+};
+
+namespace my {
+    template <>
+    struct layout_policy<char, long> : identity<declaration_order> {};
+    template <>
+    struct is_trivially_relocatable<relocatable> : Bool<true> {};
+} // namespace my
+
+void test_storage() {
+    using record = my::tuple<int, double, float>;
+    static_assert(std::is_trivially_copyable<record>::value, "trivially copyable elements give a trivially copyable tuple");
+    static_assert(std::is_trivially_destructible<record>::value, "trivially destructible elements give a trivially destructible tuple");
+    static_assert(std::is_standard_layout<record>::value, "standard-layout elements give a standard-layout tuple");
+    static_assert(sizeof(record) == 16, "elements are packed by alignment");
+    static_assert(sizeof(my::tuple<char, double, char, int>) == 16, "elements are packed by alignment");
+    static_assert(!std::is_trivially_copyable<my::tuple<std::string, int>>::value, "non-trivial elements give a non-trivial tuple");
+
+    static_assert(std::is_empty<my::tuple<empty>>::value, "empty elements take no space");
+    static_assert(sizeof(my::tuple<int, empty>) == sizeof(int), "empty elements take no space");
+
+    // the members of empty elements do not reach the tuple
+    my::tuple<equatable, equatable, int> e1, e2;
+    assert(e1 == e2);
+
+    // nested tuples holding the same empty types keep their elements apart
+    my::tuple<empty, my::tuple<empty>> nested;
+    assert(&my::get<0>(nested) != &my::get<0>(my::get<1>(nested)));
+
+    // elements are laid out as in a plain struct sorted by alignment
+    record r(1, 2, 3);
+    auto base = reinterpret_cast<char const*>(&r);
+    assert(reinterpret_cast<char const*>(&my::get<1>(r)) - base == 0);
+    assert(reinterpret_cast<char const*>(&my::get<0>(r)) - base == 8);
+    assert(reinterpret_cast<char const*>(&my::get<2>(r)) - base == 12);
+
+    // references assign through
+    int i = 1;
+    double d = 2;
+    auto refs = my::tie(i, d);
+    refs = my::make_tuple(3, 4.0);
+    assert(i == 3 && d == 4.0);
+
+    // uses-allocator construction reaches the elements
+    my::tuple<int, std::string> with_alloc(std::allocator_arg, std::allocator<char>{}, 1, std::string("one"));
+    assert(my::get<1>(with_alloc) == "one");
+
+    my::tuple<std::string, int> x("x", 1);
+    my::tuple<std::string, int> y("y", 2);
+    swap(x, y);
+    assert(my::get<0>(x) == "y" && my::get<1>(y) == 1);
+
+    // get on an rvalue tuple moves the element out, and references stay references
+    static_assert(std::is_same<decltype(my::get<0>(std::move(x))), std::string&&>::value,
+        "rvalue tuples give rvalue elements");
+    static_assert(std::is_same<decltype(my::get<0>(std::move(refs))), int&>::value,
+        "lvalue reference elements stay lvalues");
+    my::tuple<counted, int> source(counted(1), 2);
+    counted::copies = counted::moves = 0;
+    counted taken = my::get<0>(std::move(source));
+    assert(taken.value == 1 && counted::moves == 1 && counted::copies == 0);
+}
+
+template <typename T, typename Tuple>
+std::ptrdiff_t end_offset(T const& element, Tuple const& t) {
+    return reinterpret_cast<char const*>(&element) + sizeof(T) - reinterpret_cast<char const*>(&t);
+}
+
+void test_layout_policies() {
+    static_assert(sizeof(my::tuple<char, int, double>) == 16, "decreasing alignment packs tightly");
+
+    // hot elements go in the first cache line; no extra space when decreasing alignment gets them there
+    using record = my::tuple<blob, double, blob, my::hot<int>, char, my::hot<long>>;
+    static_assert(std::is_same<std::tuple_element<3, record>::type, int>::value, "annotations are not part of the element type");
+    static_assert(sizeof(record) <= sizeof(std::tuple<blob, double, blob, int, char, long>), "no bigger than std::tuple");
+    record r(blob{}, 1.0, blob{}, 3, 'c', 5L);
+    auto base = reinterpret_cast<char const*>(&r);
+    assert(reinterpret_cast<char const*>(&my::get<3>(r)) + sizeof(int) - base <= 64);
+    assert(reinterpret_cast<char const*>(&my::get<5>(r)) + sizeof(long) - base <= 64);
+    assert(my::get<3>(r) == 3 && my::get<4>(r) == 'c' && my::get<5>(r) == 5);
+
+    // otherwise they go first, and the cold elements that need less alignment fill the gap after them
+    my::tuple<wide, my::hot<char>> w;
+    assert(reinterpret_cast<char const*>(&my::get<1>(w)) == reinterpret_cast<char const*>(&w));
+
+    using doubles = my::tuple<double, double, double, double, double, double, double, double, double, double, my::hot<int>, int>;
+    static_assert(sizeof(doubles) == 88, "no extra space when the gap is filled");
+    doubles d;
+    assert(end_offset(my::get<10>(d), d) <= 64);
+
+    using longs = my::tuple<long, long, long, long, long, long, long, long, long, my::hot<char>, char>;
+    static_assert(sizeof(longs) == sizeof(std::tuple<long, long, long, long, long, long, long, long, long, char, char>), "no bigger than std::tuple");
+    longs l;
+    assert(end_offset(my::get<9>(l), l) <= 64);
+
+    using mixed = my::tuple<wide, my::hot<int>, my::hot<char>, short>;
+    static_assert(sizeof(mixed) == 88, "no extra space when the gap is filled");
+    mixed m;
+    assert(end_offset(my::get<1>(m), m) <= 64 && end_offset(my::get<2>(m), m) <= 64);
+
+    // annotations do not get in the way of conversions
+    my::tuple<my::hot<int>, double> h(1, 2.0);
+    my::tuple<long, double> p(h);
+    assert(my::get<0>(p) == 1 && my::get<1>(p) == 2.0);
+    my::tuple<long, double> q(my::tuple<my::hot<int>, double>(3, 4.0));
+    assert(my::get<0>(q) == 3);
+    q = h;
+    assert(my::get<0>(q) == 1);
+    p = my::tuple<my::hot<int>, double>(5, 6.0);
+    assert(my::get<0>(p) == 5 && my::get<1>(p) == 6.0);
+
+    // the gap is filled from anywhere among the cold elements that fit it
+    using scattered = my::tuple<float, my::hot<long>, int, my::hot<blob>, odd12, my::hot<int>, w16>;
+    static_assert(sizeof(scattered) == 96, "no extra space when the gap is filled");
+    scattered sc;
+    assert(end_offset(my::get<1>(sc), sc) <= 64 && end_offset(my::get<3>(sc), sc) <= 64 && end_offset(my::get<5>(sc), sc) <= 64);
+
+    // and when the gap fillers would push them out, they go first on their own
+    using crowded = my::tuple<wide, counts, my::hot<char>, char>;
+    static_assert(sizeof(crowded) <= sizeof(std::tuple<wide, counts, char, char>), "no bigger than std::tuple");
+    crowded c;
+    assert(end_offset(my::get<2>(c), c) <= 64);
+}
+
+void test_tuple_cat() {
+    my::tuple<counted, int> a(counted(1), 2);
+    std::tuple<double, counted> b(3.0, counted(4));
+    std::pair<char, counted> c('5', counted(6));
+
+    // rvalue arguments: every element is moved exactly once, straight into place
+    counted::copies = counted::moves = 0;
+    auto moved = my::tuple_cat(std::move(a), std::move(b), std::move(c));
+    static_assert(std::is_same<decltype(moved), my::tuple<counted, int, double, counted, char, counted>>::value,
+        "tuple_cat concatenates the element types");
+    assert(counted::copies == 0 && counted::moves == 3);
+    assert(my::get<0>(moved).value == 1 && my::get<1>(moved) == 2 && my::get<2>(moved) == 3.0);
+    assert(my::get<3>(moved).value == 4 && my::get<4>(moved) == '5' && my::get<5>(moved).value == 6);
+
+    // lvalue arguments: every element is copied exactly once
+    counted::copies = counted::moves = 0;
+    auto copied = my::tuple_cat(a, b, c);
+    assert(counted::copies == 3 && counted::moves == 0);
+    (void)copied;
+
+    int i = 1;
+    auto refs = my::tuple_cat(my::tie(i), my::tuple<>(), std::make_tuple(2));
+    my::get<0>(refs) = 3;
+    assert(i == 3);
+}
+
+void test_soa_vector() {
+    my::soa_vector<char, double, std::string, int> v;
+    for(int i = 0; i < 100; ++i) {
+        v.push_back(my::make_tuple(char('a' + i % 26), i * 0.5, std::to_string(i), i));
+    }
+    v.emplace_back('z', 1.0, "last", 100);
+    assert(v.size() == 101);
+
+    // columns are contiguous and aligned
+    auto ints = v.column<3>();
+    assert(ints.size() == 101);
+    long total = 0;
+    for(int n : ints) total += n;
+    assert(total == 5050);
+    assert(reinterpret_cast<std::uintptr_t>(v.column<1>().data()) % alignof(double) == 0);
+    assert(reinterpret_cast<std::uintptr_t>(v.column<3>().data()) % alignof(int) == 0);
+
+    // rows are proxies
+    my::get<1>(v[0]) = 9;
+    assert(v.column<1>()[0] == 9);
+    assert(my::get<2>(v[42]) == "42");
+
+    auto copy = v;
+    assert(my::get<2>(copy.back()) == "last");
+    int rows = 0;
+    for(auto row : copy) {
+        assert(my::get<3>(row) == rows);
+        ++rows;
+    }
+    assert(rows == 101);
+
+    copy.pop_back();
+    assert(copy.size() == 100);
+    copy.clear();
+    assert(copy.empty());
+
+    // rows can be appended from the container itself, even when it grows
+    my::soa_vector<std::string, int> self;
+    for(int i = 0; i < 8; ++i) self.emplace_back(std::to_string(i), i);
+    assert(self.size() == self.capacity());
+    self.push_back(self[0]);
+    self.emplace_back(my::get<0>(self[1]), my::get<1>(self[1]));
+    assert(self.size() == 10 && my::get<0>(self[8]) == "0" && my::get<0>(self[9]) == "1");
+
+    // columns go by decreasing alignment whatever the layout policy of the tuple
+    my::soa_vector<char, long> odd;
+    odd.reserve(3);
+    odd.emplace_back('a', 1L);
+    assert(reinterpret_cast<std::uintptr_t>(odd.column<1>().data()) % alignof(long) == 0);
+    assert(my::get<1>(odd[0]) == 1);
+
+    my::soa_vector<my::hot<int>, double> annotated;
+    annotated.push_back(my::tuple<my::hot<int>, double>(1, 2.0));
+    assert(annotated.column<0>()[0] == 1 && annotated.column<1>()[0] == 2.0);
+
+    // a column can hold tuples of its own
+    my::soa_vector<my::tuple<int, int>> nested;
+    nested.emplace_back(my::tuple<int, int>(1, 2));
+    assert(my::get<1>(nested.column<0>()[0]) == 2);
+
+    // growing copies every column when any of them could throw while moving, so that a
+    // failure leaves the old rows as they were
+    my::soa_vector<std::string, fragile> safe;
+    for(int i = 0; i < 8; ++i) safe.emplace_back(std::to_string(i), i);
+    fragile::fail = true;
+    try {
+        safe.emplace_back("last", 8);
+        assert(false);
+    } catch(int) {}
+    fragile::fail = false;
+    assert(safe.size() == 8 && my::get<0>(safe[0]) == "0" && my::get<1>(safe[7]).value == 7);
+
+    // converting rvalue tuples are moved from
+    my::soa_vector<counted, int> moved;
+    counted::copies = counted::moves = 0;
+    moved.push_back(my::tuple<counted, long>(counted(1), 2L));
+    assert(counted::copies == 0 && moved.column<0>()[0].value == 1 && moved.column<1>()[0] == 2);
+}
+
+void test_comparisons() {
+    // lexicographic in interface order, even though the double is stored first
+    my::tuple<char, double> a('a', 2.0);
+    my::tuple<char, double> b('b', 1.0);
+    assert(a < b && !(b < a) && a <= b && b > a && b >= a && a != b);
+    assert(my::make_tuple(1, 2.0) < my::make_tuple(1L, 3.0f));
+    assert(my::make_tuple(1, 2.0) == my::make_tuple(1L, 2.0f));
+
+    // blocks of integers compare and hash in one go, the rest element by element
+    using key = my::tuple<std::uint16_t, std::uint64_t, char, std::string, std::uint32_t>;
+    key k(1, 2, 'c', "d", 5);
+    assert(k == key(1, 2, 'c', "d", 5));
+    assert(std::hash<key>{}(k) == std::hash<key>{}(key(1, 2, 'c', "d", 5)));
+    assert(k != key(0, 2, 'c', "d", 5) && k != key(1, 0, 'c', "d", 5) && k != key(1, 2, 'x', "d", 5));
+    assert(k != key(1, 2, 'c', "x", 5) && k != key(1, 2, 'c', "d", 0));
+
+    // padding is never compared nor hashed
+    using padded = my::tuple<char, long>;
+    alignas(padded) unsigned char zeros[sizeof(padded)];
+    alignas(padded) unsigned char ones[sizeof(padded)];
+    std::memset(zeros, 0, sizeof(zeros));
+    std::memset(ones, 0xff, sizeof(ones));
+    auto& x = *::new(zeros) padded('x', 1);
+    auto& y = *::new(ones) padded('x', 1);
+    assert(reinterpret_cast<unsigned char*>(&my::get<1>(x)) - zeros == alignof(long));
+    assert(x == y && std::hash<padded>{}(x) == std::hash<padded>{}(y));
+
+    std::unordered_set<key> set;
+    set.insert(k);
+    set.insert(key(1, 2, 'c', "d", 5));
+    set.insert(key(1, 2, 'c', "e", 5));
+    assert(set.size() == 2 && set.count(k) == 1);
+    assert(my::tuple<>() == my::tuple<>() && std::hash<my::tuple<>>{}(my::tuple<>()) == 0);
+
+    // empty elements take no bytes, but still compare with their own equality
+    assert(!(my::tuple<weird, int>() == my::tuple<weird, int>()));
+    assert(!(std::tuple<weird, int>() == std::tuple<weird, int>()));
+}
+
+enum class color { red, green, blue };
+
+void test_packed_tuple() {
+    using flags = my::packed_tuple<my::bits<1, bool>, std::uint32_t, my::bits<2, color>, my::bits<1, bool>,
+                                   my::bits<5, int>, char, my::bits<12, std::uint16_t>>;
+    static_assert(sizeof(flags) == 8, "packed elements share a byte block after the others");
+    static_assert(sizeof(my::tuple<bool, std::uint32_t, color, bool, int, char, std::uint16_t>) == 20, "plain elements take whole bytes");
+    static_assert(std::is_trivially_copyable<flags>::value, "trivially copyable elements give a trivially copyable packed tuple");
+    static_assert(std::is_same<std::tuple_element<2, flags>::type, color>::value, "annotations are not part of the element type");
+
+    flags f;
+    assert(!my::get<0>(f) && my::get<1>(f) == 0 && my::get<2>(f) == color::red && my::get<6>(f) == 0);
+
+    flags g(true, 70000, color::blue, false, -7, 'c', 4095);
+    assert(my::get<0>(g) && my::get<1>(g) == 70000 && my::get<2>(g) == color::blue && !my::get<3>(g));
+    assert(my::get<4>(g) == -7 && my::get<5>(g) == 'c' && my::get<6>(g) == 4095);
+
+    // writing through the proxies leaves the neighbouring fields alone
+    my::get<3>(g) = true;
+    my::get<4>(g) = 15;
+    my::get<6>(g) = 1;
+    my::get<1>(g) = 5;
+    assert(my::get<0>(g) && my::get<2>(g) == color::blue && my::get<3>(g));
+    assert(my::get<4>(g) == 15 && my::get<6>(g) == 1 && my::get<1>(g) == 5);
+    my::get<4>(g) = -16;
+    assert(my::get<4>(g) == -16 && my::get<3>(g) && my::get<6>(g) == 1);
+    my::get<2>(f) = my::get<2>(g);
+    assert(my::get<2>(f) == color::blue);
+
+    auto plain = my::unpack(g);
+    static_assert(std::is_same<decltype(plain), my::tuple<bool, std::uint32_t, color, bool, int, char, std::uint16_t>>::value,
+        "unpacking gives a plain tuple of the element types");
+    assert(plain == my::make_tuple(true, 5u, color::blue, true, -16, 'c', std::uint16_t(1)));
+    assert(flags(plain) == g && flags(plain) != f);
+
+    my::packed_tuple<std::string, int> no_bits("x", 1);
+    assert(sizeof(no_bits) == sizeof(my::tuple<std::string, int>) && my::get<0>(no_bits) == "x");
+}
+
+// the descriptor offsets match where the elements really are
+template <typename... T, std::size_t... I>
+void check_offsets(my::tuple<T...> const& t, my::indices<I...>) {
+    using descriptor = my::layout_descriptor<my::tuple<T...>>;
+    auto base = reinterpret_cast<char const*>(&t);
+    bool match = true;
+    (void)my::swallow{ 0, (match = match && (std::is_empty<my::PackElement<I, T...>>::value
+                                             || reinterpret_cast<char const*>(&my::get<I>(t)) - base == std::ptrdiff_t(descriptor::offsets[I])), 0)... };
+    assert(match);
+}
+template <typename... T>
+void check_offsets() {
+    my::tuple<T...> t;
+    check_offsets(t, my::IndicesUpTo<sizeof...(T)>{});
+}
+
+void test_tuple_view() {
+    check_offsets<int, double, float>();
+    check_offsets<char, long>();
+    check_offsets<char, empty, std::uint16_t, double, empty, long double, char>();
+    check_offsets<blob, double, blob, my::hot<int>, char, my::hot<long>>();
+    check_offsets<wide, my::hot<char>>();
+    check_offsets<wide, my::hot<char>, char>();
+    check_offsets<wide, my::hot<int>, my::hot<char>, short>();
+    check_offsets<wide, counts, my::hot<char>, char>();
+    check_offsets<float, my::hot<long>, int, my::hot<blob>, odd12, my::hot<int>, w16>();
+    check_offsets<char, int, double>();
+
+    using record = my::tuple<std::uint32_t, double, char, std::int16_t>;
+    using descriptor = my::layout_descriptor<record>;
+    static_assert(descriptor::size == sizeof(record) && descriptor::offsets[1] == 0 && descriptor::sizes[3] == 2, "layout is known at compile time");
+    static_assert(descriptor::schema != my::layout_descriptor<my::tuple<std::uint32_t, double, char, std::uint16_t>>::schema,
+        "signedness is part of the schema");
+    static_assert(descriptor::schema != my::layout_descriptor<my::tuple<double, std::uint32_t, char, std::int16_t>>::schema,
+        "interface order is part of the schema");
+
+    record r(1, 2.5, 'c', -4);
+    my::tuple_view<std::uint32_t, double, char, std::int16_t> view(reinterpret_cast<unsigned char const*>(&r));
+    assert(my::get<0>(view) == 1 && my::get<1>(view) == 2.5 && my::get<2>(view) == 'c' && my::get<3>(view) == -4);
+    assert(&my::get<1>(view) == &my::get<1>(r) && view.load() == r);
+
+#if defined(__unix__) || defined(__APPLE__)
+    char path[] = "/tmp/tuple_view_test_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    {
+        my::tuple_writer<std::uint32_t, double, char, std::int16_t> writer(path, 7);
+        for(int i = 0; i < 100; ++i) writer.append(record(i, i * 0.5, char('a' + i % 26), std::int16_t(-i)));
+    }
+    {
+        // appending to an existing file keeps its header
+        std::vector<record> more { record(100, 50.0, 'w', -100), record(101, 50.5, 'x', -101) };
+        my::tuple_writer<std::uint32_t, double, char, std::int16_t> writer(path);
+        writer.append(more.begin(), more.end());
+    }
+
+    my::mapped_file file(path);
+    my::tuple_records<std::uint32_t, double, char, std::int16_t> records(file.data(), file.size());
+    assert(records.size() == 102);
+    for(std::size_t i = 0; i < records.size(); ++i) {
+        assert(my::get<0>(records[i]) == i && my::get<1>(records[i]) == i * 0.5);
+        assert(my::get<2>(records[i]) == char('a' + i % 26) && my::get<3>(records[i]) == -int(i));
+    }
+
+    // readers and writers with another layout are turned away
+    bool rejected = false;
+    try {
+        my::tuple_records<std::uint32_t, double, char, std::uint16_t> wrong(file.data(), file.size());
+    } catch(my::layout_mismatch const&) {
+        rejected = true;
+    }
+    assert(rejected);
+    rejected = false;
+    try {
+        my::tuple_writer<double, std::uint32_t, char, std::int16_t> wrong(path);
+    } catch(my::layout_mismatch const&) {
+        rejected = true;
+    }
+    assert(rejected);
+    std::remove(path);
+#endif
+}
+
+void test_tuple_vector() {
+    static_assert(my::is_trivially_relocatable<my::tuple<int, std::unique_ptr<int>, relocatable, int&>>::value,
+        "tuples of trivially relocatable elements are trivially relocatable");
+    static_assert(!my::is_trivially_relocatable<my::tuple<int, counted>>::value,
+        "one element that is not trivially relocatable is enough");
+
+    // growing and shifting never move a trivially relocatable row
+    my::tuple_vector<relocatable, std::unique_ptr<int>, double> v;
+    counted::copies = counted::moves = 0;
+    for(int i = 0; i < 100; ++i) v.emplace_back(relocatable(i), std::unique_ptr<int>(new int(i)), i * 0.5);
+    assert(counted::moves == 100 && counted::copies == 0);
+    auto row = my::make_tuple(relocatable(-1), std::unique_ptr<int>(new int(-1)), -0.5);
+    counted::moves = 0;
+    v.insert(v.begin() + 10, std::move(row));
+    assert(counted::moves == 1);
+    v.erase(v.begin(), v.begin() + 5);
+    assert(v.size() == 96);
+    assert(my::get<0>(v[5]).value == -1 && *my::get<1>(v[5]) == -1);
+    assert(my::get<0>(v[4]).value == 9 && my::get<0>(v[6]).value == 10 && *my::get<1>(v.back()) == 99);
+
+    // inserting into a full vector relocates each old row once, around the new one
+    my::tuple_vector<relocatable, int> full;
+    for(int i = 0; i < 8; ++i) full.emplace_back(relocatable(i), i);
+    assert(full.size() == full.capacity());
+    counted::moves = 0;
+    full.emplace(full.begin() + 3, relocatable(-1), -1);
+    assert(counted::moves == 1 && full.size() == 9);
+    assert(my::get<0>(full[2]).value == 2 && my::get<0>(full[3]).value == -1 && my::get<0>(full[4]).value == 3);
+    assert(my::get<1>(full[8]) == 7);
+
+    // others are moved one by one
+    my::tuple_vector<std::string, int> w;
+    for(int i = 0; i < 20; ++i) w.emplace_back(std::to_string(i), i);
+    w.insert(w.begin(), my::make_tuple(std::string("first"), -1));
+    w.erase(w.begin() + 1);
+    assert(w.size() == 20 && my::get<0>(w[0]) == "first" && my::get<0>(w[1]) == "1" && my::get<1>(w.back()) == 19);
+    auto copy = w;
+    assert(my::get<0>(copy[19]) == "19");
+
+    // the arguments may refer to the rows that shift
+    w.insert(w.begin() + 1, w[19]);
+    w.insert(w.begin() + 2, w[0]);
+    assert(my::get<0>(w[1]) == "19" && my::get<0>(w[2]) == "first" && my::get<1>(w.back()) == 19);
+
+    // bulk algorithms
+    my::tuple<int, double> a[3] = { my::tuple<int, double>(1, 1.0), my::tuple<int, double>(2, 2.0), my::tuple<int, double>(3, 3.0) };
+    my::tuple<int, double> b[3] = { my::tuple<int, double>(4, 4.0), my::tuple<int, double>(5, 5.0), my::tuple<int, double>(6, 6.0) };
+    my::swap_ranges(a, a + 3, b);
+    assert(my::get<0>(a[0]) == 4 && my::get<0>(b[2]) == 3);
+    my::relocate_n(a, 2, a + 1);
+    assert(my::get<0>(a[1]) == 4 && my::get<0>(a[2]) == 5);
+    std::string s[2] = { "x", "y" };
+    std::string t[2] = { "z", "w" };
+    my::swap_ranges(s, s + 2, t);
+    assert(s[0] == "z" && t[1] == "y");
+}
+
+void test_pmr_tuple() {
+#if defined(__cpp_lib_memory_resource)
+    static_assert(std::is_same<my::pmr::tuple<std::string, int, std::vector<std::string>, my::tuple<std::string>>,
+                               my::tuple<std::pmr::string, int, std::pmr::vector<std::pmr::string>, my::tuple<std::pmr::string>>>::value,
+        "allocating elements switch to polymorphic allocators");
+
+    // every allocating element, nested ones included, gets the resource
+    my::pmr::counting_resource counter;
+    std::string const long_text(100, 'x');
+    {
+        my::pmr::tuple<std::string, int, my::tuple<std::string>> t(std::allocator_arg, my::pmr::allocator_type(&counter),
+                                                                  long_text, 1, my::tuple<std::string>(long_text));
+        assert(my::get<0>(t).get_allocator().resource() == &counter);
+        assert(my::get<0>(my::get<2>(t)).get_allocator().resource() == &counter);
+        assert(counter.stats().allocations == 2 && counter.stats().bytes_in_use > 0);
+    }
+    assert(counter.stats().deallocations == 2 && counter.stats().bytes_in_use == 0);
+
+    // the arena serves many small allocations from a few large upstream ones
+    my::pmr::counting_resource upstream;
+    {
+        my::pmr::tuple_arena<std::string, int, std::vector<int>> arena(&upstream);
+        for(int i = 0; i < 1000; ++i) {
+            auto& t = arena.emplace(long_text, i, std::pmr::vector<int>{ i, i, i });
+            assert(my::get<1>(t) == i && my::get<2>(t).size() == 3);
+        }
+        assert(arena.size() == 1000);
+        assert(arena.stats().allocations >= 2000);
+        assert(arena.upstream_stats().allocations < 20 && upstream.stats().allocations == arena.upstream_stats().allocations);
+        arena.release();
+        assert(arena.empty() && upstream.stats().bytes_in_use == 0);
+        arena.emplace(long_text, 0, std::pmr::vector<int>{});
+    }
+    assert(upstream.stats().bytes_in_use == 0);
+
+    {
+        my::pmr::pool_tuple_arena<std::string, double> pool(&upstream);
+        for(int i = 0; i < 100; ++i) pool.emplace(long_text, i * 0.5);
+        assert(pool.size() == 100 && pool.stats().allocations >= 100);
+    }
+    assert(upstream.stats().bytes_in_use == 0);
+#endif
+}
 
 int main() {
     my::tuple<int, double, float> t1(1,2,3);
     my::tuple<int, int, int> t2 = t1;
+    assert(my::get<0>(t2) == 1);
+    assert(my::get<1>(t2) == 2);
+    assert(my::get<2>(t2) == 3);
 
     my::get<0>(t1) = 4;
     my::get<1>(t1) = 3.2;
@@ -19,5 +576,14 @@ int main() {
     assert(my::get<0>(t1) == 4);
     assert(my::get<1>(t1) == 3.2);
     assert(my::get<2>(t1) == 1.2f);
-}
 
+    test_storage();
+    test_layout_policies();
+    test_tuple_cat();
+    test_soa_vector();
+    test_comparisons();
+    test_packed_tuple();
+    test_tuple_view();
+    test_tuple_vector();
+    test_pmr_tuple();
+}
@@ -19,6 +19,8 @@
 #include <memory>
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 
 namespace my {
     // utils
@@ -39,24 +41,20 @@ namespace my {
     template <std::size_t I, typename T>
     using TupleElement = typename std::tuple_element<I, T>::type;
 
-    template <std::size_t Acc, std::size_t... Tail>
-    struct max;
-    template <std::size_t Acc>
-    struct max<Acc> : std::integral_constant<std::size_t, Acc> {};
-    template <std::size_t Acc, std::size_t Head, std::size_t... Tail>
-    struct max<Acc, Head, Tail...>
-    : std::conditional<Acc < Head, max<Head, Tail...>, max<Acc, Tail...>>::type {};
-
     template <bool B>
     using Bool = std::integral_constant<bool, B>;
 
     template <typename Cond, typename Then, typename Else>
     using Conditional = typename std::conditional<Cond::value, Then, Else>::type;
 
+    // evaluating a pack expansion only for its side-effects
+    using swallow = int[];
+
+    // no recursion, so that long lists do not nest instantiations
+    template <bool... B>
+    struct bool_list {};
     template <typename... T>
-    struct All : Bool<true> {};
-    template <typename Head, typename... Tail>
-    struct All<Head, Tail...> : Conditional<Head, All<Tail...>, Bool<false>> {};
+    struct All : std::is_same<bool_list<true, T::value...>, bool_list<T::value..., true>> {};
 
     enum class enabler {};
     template <typename... Cond>
@@ -70,6 +68,9 @@ namespace my {
     // wait a moment! GCC needs a goat sacrifice
 } // namespace my
 namespace std {
+    template < ::std::size_t... Is>
+    struct tuple_size< ::my::indices<Is...>>
+    : ::std::integral_constant< ::std::size_t, sizeof...(Is)> {};
     template < ::std::size_t I, ::std::size_t... Is>
     struct tuple_element<I, ::my::indices<Is...>>
     : ::std::tuple_element<I, ::std::tuple< ::my::index<Is>...>> {};
@@ -80,23 +81,249 @@ namespace my {
     using indices = std::tuple<index<I>...>;
     */
 
-    template <std::size_t... N>
-    struct indices_builder {
-        using type = indices<N...>;
-        using next = indices_builder<N..., sizeof...(N)>;
+    // The compiler generates index lists when it knows how; otherwise they are built by
+    // doubling, so that the instantiation depth stays logarithmic in the length.
+#if defined(__has_builtin)
+#  if __has_builtin(__make_integer_seq)
+#    define MY_TUPLE_MAKE_INTEGER_SEQ
+#  elif __has_builtin(__integer_pack)
+#    define MY_TUPLE_INTEGER_PACK
+#  endif
+#endif
+#if defined(__has_cpp_attribute)
+#  if __has_cpp_attribute(__no_unique_address__)
+#    define MY_TUPLE_NO_UNIQUE_ADDRESS
+#  endif
+#endif
+#if defined(MY_TUPLE_MAKE_INTEGER_SEQ)
+    template <typename T, T... I>
+    struct integer_seq_indices : identity<indices<I...>> {};
+    template <std::size_t N>
+    struct indices_up_to : __make_integer_seq<integer_seq_indices, std::size_t, N> {};
+#elif defined(MY_TUPLE_INTEGER_PACK)
+    template <std::size_t N>
+    struct indices_up_to : identity<indices<__integer_pack(N)...>> {};
+#else
+    template <typename Left, typename Right>
+    struct join_indices;
+    template <std::size_t... I, std::size_t... J>
+    struct join_indices<indices<I...>, indices<J...>>
+    : identity<indices<I..., (sizeof...(I) + J)...>> {};
+
+    template <std::size_t N>
+    struct indices_up_to
+    : join_indices<typename indices_up_to<N / 2>::type, typename indices_up_to<N - N / 2>::type> {};
+    template <>
+    struct indices_up_to<0> : identity<indices<>> {};
+    template <>
+    struct indices_up_to<1> : identity<indices<0>> {};
+#endif
+#undef MY_TUPLE_MAKE_INTEGER_SEQ
+#undef MY_TUPLE_INTEGER_PACK
+    template <std::size_t N>
+    using IndicesUpTo = typename indices_up_to<N>::type;
+    template <typename Tuple>
+    using IndicesFor = IndicesUpTo<std::tuple_size<Tuple>::value>;
+
+    // packing types with indices
+    template <typename T, std::size_t I>
+    struct indexed {
+        using type = T;
+        static constexpr auto i = I;
+    };
+
+    // finding the base indexed with I, by deduction; the call is qualified because ADL would
+    // go through all the template arguments of the derived class every time
+    template <std::size_t I, typename T>
+    indexed<T, I> find_indexed(indexed<T, I> const*);
+    template <std::size_t I, typename Bases>
+    using FindIndexed = typename decltype(my::find_indexed<I>(std::declval<Bases*>()))::type;
+
+    // Index arithmetic
+    //
+    // Orders and maps are computed by constexpr functions over arrays, and expanded back into
+    // packs afterwards. Nothing recurses once per element, so neither the instantiation depth
+    // nor the number of instantiations grows with the length of the lists.
+    template <typename Indices>
+    struct index_array;
+    template <std::size_t... I>
+    struct index_array<indices<I...>> {
+        // never empty, because zero-length arrays are not allowed
+        static constexpr std::size_t values[sizeof...(I) + 1] = { I..., 0 };
     };
+    template <std::size_t... I>
+    constexpr std::size_t index_array<indices<I...>>::values[sizeof...(I) + 1];
+
+    // the I-th element of a list of indices
+    template <std::size_t I, typename Indices>
+    using IndexAt = index<index_array<Indices>::values[I]>;
+
+    constexpr std::size_t midpoint(std::size_t first, std::size_t last) {
+        return first + (last - first) / 2;
+    }
+
+    // reductions over [first, last), splitting in halves
+    constexpr std::size_t array_sum(std::size_t const* a, std::size_t first, std::size_t last) {
+        return last - first == 0? 0
+             : last - first == 1? a[first]
+             : array_sum(a, first, midpoint(first, last)) + array_sum(a, midpoint(first, last), last);
+    }
+    constexpr std::size_t larger(std::size_t a, std::size_t b) {
+        return a < b? b : a;
+    }
+    constexpr std::size_t array_max(std::size_t const* a, std::size_t first, std::size_t last) {
+        return last - first == 0? 0
+             : last - first == 1? a[first]
+             : larger(array_max(a, first, midpoint(first, last)), array_max(a, midpoint(first, last), last));
+    }
+
+    template <std::size_t... N>
+    struct sum : index<array_sum(index_array<indices<N...>>::values, 0, sizeof...(N))> {};
+    template <std::size_t... N>
+    struct max : index<array_max(index_array<indices<N...>>::values, 0, sizeof...(N))> {};
+
+    // a contiguous part of a list of indices
+    template <typename Indices, std::size_t First, typename Positions>
+    struct slice_impl;
+    template <typename Indices, std::size_t First, std::size_t... K>
+    struct slice_impl<Indices, First, indices<K...>>
+    : identity<indices<index_array<Indices>::values[First + K]...>> {};
+    template <typename Indices, std::size_t First, std::size_t Count>
+    using Slice = typename slice_impl<Indices, First, IndicesUpTo<Count>>::type;
+
+    template <std::size_t First, typename Indices>
+    struct offset_indices;
+    template <std::size_t First, std::size_t... I>
+    struct offset_indices<First, indices<I...>> : identity<indices<(First + I)...>> {};
+    template <std::size_t First, std::size_t Last>
+    using IndicesBetween = typename offset_indices<First, IndicesUpTo<Last - First>>::type;
+
+    // the first position in [first, last) that does not hold v, or last
+    constexpr std::size_t found_either(std::size_t left, std::size_t middle, std::size_t right) {
+        return left != middle? left : right;
+    }
+    constexpr std::size_t find_other(std::size_t const* a, std::size_t v, std::size_t first, std::size_t last) {
+        return last - first == 0? last
+             : last - first == 1? (a[first] != v? first : last)
+             : found_either(find_other(a, v, first, midpoint(first, last)), midpoint(first, last),
+                            find_other(a, v, midpoint(first, last), last));
+    }
+    // the first position in [first, last) that holds more than the one before it, or last;
+    // first is never zero
+    constexpr std::size_t find_rise(std::size_t const* a, std::size_t first, std::size_t last) {
+        return last - first == 0? last
+             : last - first == 1? (a[first - 1] < a[first]? first : last)
+             : found_either(find_rise(a, first, midpoint(first, last)), midpoint(first, last),
+                            find_rise(a, midpoint(first, last), last));
+    }
+
+#if __cplusplus >= 201402L
+    // C++14 lets whole orders be computed in a single constexpr call
     template <std::size_t N>
-    struct indices_up_to {
-        using builder = typename indices_up_to<N-1>::builder::next;
-        using type = typename builder::type;
+    struct index_table {
+        std::size_t at[N + 1];
     };
-    template <>
-    struct indices_up_to<0> {
-        using builder = indices_builder<>;
-        using type = std::tuple<>;
+
+    // stable sort by decreasing key: one pass per distinct key
+    template <std::size_t... K>
+    constexpr index_table<sizeof...(K)> make_stable_order() {
+        std::size_t const keys[] = { K..., 0 };
+        index_table<sizeof...(K)> order {};
+        std::size_t n = 0;
+        bool bounded = false;
+        std::size_t bound = 0;
+        while(n < sizeof...(K)) {
+            std::size_t key = 0;
+            for(std::size_t i = 0; i < sizeof...(K); ++i) {
+                if((!bounded || keys[i] < bound) && key < keys[i]) key = keys[i];
+            }
+            for(std::size_t i = 0; i < sizeof...(K); ++i) {
+                if(keys[i] == key) order.at[n++] = i;
+            }
+            bounded = true;
+            bound = key;
+        }
+        return order;
+    }
+
+    // inverse of a permutation, in one pass
+    template <std::size_t... M>
+    constexpr index_table<sizeof...(M)> make_inverse() {
+        std::size_t const map[] = { M..., 0 };
+        index_table<sizeof...(M)> inverse {};
+        for(std::size_t i = 0; i < sizeof...(M); ++i) {
+            inverse.at[map[i]] = i;
+        }
+        return inverse;
+    }
+
+    template <typename Keys>
+    struct stable_order_table;
+    template <std::size_t... K>
+    struct stable_order_table<indices<K...>> {
+        static constexpr index_table<sizeof...(K)> value = make_stable_order<K...>();
+    };
+    template <typename Map>
+    struct inverse_table;
+    template <std::size_t... M>
+    struct inverse_table<indices<M...>> {
+        static constexpr index_table<sizeof...(M)> value = make_inverse<M...>();
     };
-    template <typename Tuple>
-    using IndicesFor = typename indices_up_to<std::tuple_size<Tuple>::value>::type;
+
+    template <typename Keys, typename Positions = IndicesFor<Keys>>
+    struct stable_order;
+    template <typename Keys, std::size_t... I>
+    struct stable_order<Keys, indices<I...>>
+    : identity<indices<stable_order_table<Keys>::value.at[I]...>> {};
+
+    template <typename Map, typename Positions = IndicesFor<Map>>
+    struct inverse_map;
+    template <typename Map, std::size_t... I>
+    struct inverse_map<Map, indices<I...>>
+    : identity<indices<inverse_table<Map>::value.at[I]...>> {};
+#else
+    // C++11 constexpr functions are single expressions. Counts are taken over halves of
+    // halves of the whole array, so that the compiler can reuse them across positions.
+    constexpr std::size_t count_equal(std::size_t const* keys, std::size_t k, std::size_t first, std::size_t last) {
+        return last - first == 0? 0
+             : last - first == 1? (keys[first] == k? 1 : 0)
+             : count_equal(keys, k, first, midpoint(first, last)) + count_equal(keys, k, midpoint(first, last), last);
+    }
+    constexpr std::size_t count_greater(std::size_t const* keys, std::size_t k, std::size_t first, std::size_t last) {
+        return last - first == 0? 0
+             : last - first == 1? (k < keys[first]? 1 : 0)
+             : count_greater(keys, k, first, midpoint(first, last)) + count_greater(keys, k, midpoint(first, last), last);
+    }
+    // how many keys in [first, last) and before i are equal to k
+    constexpr std::size_t count_equal_before(std::size_t const* keys, std::size_t k, std::size_t i, std::size_t first, std::size_t last) {
+        return i <= first? 0
+             : last <= i? count_equal(keys, k, first, last)
+             : count_equal_before(keys, k, i, first, midpoint(first, last)) + count_equal_before(keys, k, i, midpoint(first, last), last);
+    }
+    // where the key at i goes when stably sorting by decreasing key
+    constexpr std::size_t stable_rank(std::size_t const* keys, std::size_t i, std::size_t n) {
+        return count_greater(keys, keys[i], 0, n) + count_equal_before(keys, keys[i], i, 0, n);
+    }
+
+    // The inverse of a permutation is a single class, with the position of each index as a
+    // base. Looking up an index is deduction against those bases.
+    template <typename Map, typename Positions = IndicesFor<Map>>
+    struct inverse_bases;
+    template <std::size_t... M, std::size_t... I>
+    struct inverse_bases<indices<M...>, indices<I...>> : indexed<index<I>, M>... {};
+
+    template <typename Map, typename Positions = IndicesFor<Map>>
+    struct inverse_map;
+    template <typename Map, std::size_t... I>
+    struct inverse_map<Map, indices<I...>>
+    : identity<indices<FindIndexed<I, inverse_bases<Map>>::value...>> {};
+
+    template <typename Keys, typename Positions = IndicesFor<Keys>>
+    struct stable_order;
+    template <typename Keys, std::size_t... I>
+    struct stable_order<Keys, indices<I...>>
+    : inverse_map<indices<stable_rank(index_array<Keys>::values, I, sizeof...(I))...>> {};
+#endif
 
     template <typename T>
     using Decay = typename std::decay<T>::type;
@@ -114,73 +341,108 @@ namespace my {
     template <typename T>
     struct member { T _; };
 
-    // packing types with indices
-    template <typename T, std::size_t I>
-    struct indexed {
-        using type = T;
-        static constexpr auto i = I;
-    };
+    // empty elements are stored as bases
+#if __cplusplus >= 201402L
+    template <typename T>
+    using is_final = std::is_final<T>;
+#else
+    template <typename T>
+    struct is_final : Bool<__is_final(T)> {};
+#endif
+
+    template <typename T>
+    struct is_empty_element : All<std::is_class<T>, std::is_empty<T>, Bool<!is_final<T>::value>> {};
+
+    // annotation for elements that are accessed often
+    template <typename T>
+    struct hot;
+
+    template <typename T>
+    struct unannotated : identity<T> {};
+    template <typename T>
+    struct unannotated<hot<T>> : identity<T> {};
+    template <typename T>
+    using Unannotated = typename unannotated<T>::type;
 
     // attaching index information
-    template <typename Acc, typename... T>
-    struct with_indices_impl : identity<Acc> {};
-    template <typename... Acc, typename Head, typename... Tail>
-    struct with_indices_impl<std::tuple<Acc...>, Head, Tail...>
-    : with_indices_impl<std::tuple<Acc..., indexed<Head, sizeof...(Acc)>>, Tail...> {};
+    template <typename List, typename Indices = IndicesFor<List>>
+    struct with_indices;
+    template <typename... T, std::size_t... I>
+    struct with_indices<std::tuple<T...>, indices<I...>> : identity<std::tuple<indexed<T, I>...>> {};
+    template <typename List>
+    using WithIndices = typename with_indices<List>::type;
 
+    // Picking elements by index. Deduction against the bases of a single class finds any of
+    // them without instantiating anything per position.
     template <typename List>
-    struct with_indices;
+    struct inherit_all;
     template <typename... T>
-    struct with_indices<std::tuple<T...>> : with_indices_impl<std::tuple<>, T...> {};
+    struct inherit_all<std::tuple<T...>> : T... {};
+
+    // Long lists as template arguments are costly: every template instantiated with one has
+    // to go through the whole list, and templates that do something for each element end up
+    // doing it once per element. A nested class that holds the list does not have that cost,
+    // so that is what gets passed around instead.
     template <typename List>
-    using WithIndices = typename with_indices<List>::type;
+    struct hold {
+        struct type {
+            using list = List;
+            using bases = inherit_all<WithIndices<List>>;
+        };
+    };
+    template <typename List>
+    using Held = typename hold<List>::type;
+
+    template <std::size_t I, typename Elements>
+    struct held_element : identity<FindIndexed<I, typename Elements::bases>> {};
+    template <std::size_t I, typename Elements>
+    using HeldElement = typename held_element<I, Elements>::type;
+
+    template <std::size_t I, typename List>
+    using ListElement = HeldElement<I, Held<List>>;
 
-    // building lists by appending at the appropriate end
-    template <typename Head, typename Tail>
-    struct cons;
-    template <typename Head, typename... Tail>
-    struct cons<Head, std::tuple<Tail...>>
-    #if defined(MY_STD_TUPLE_LAYOUT_STRAIGHT)
-    : identity<std::tuple<Tail..., Head>> {};
-    #elif defined(MY_STD_TUPLE_LAYOUT_REVERSED)
-    : identity<std::tuple<Head, Tail...>> {};
-    #endif
-    template <typename Head, typename Tail>
-    using Cons = typename cons<Head, Tail>::type;
+    template <typename List, typename Positions>
+    struct pick;
+    template <typename List, std::size_t... P>
+    struct pick<List, indices<P...>> : identity<std::tuple<ListElement<P, List>...>> {};
+    template <typename List, typename Positions>
+    using Pick = typename pick<List, Positions>::type;
+
+    template <std::size_t N, typename List>
+    using Take = Pick<List, IndicesUpTo<N>>;
+    template <std::size_t N, typename List>
+    using Drop = Pick<List, IndicesBetween<N, std::tuple_size<List>::value>>;
+
+    // Stable sort by decreasing key
+    template <template <typename> class Key, typename List>
+    struct sort_by;
+    template <template <typename> class Key, typename... T>
+    struct sort_by<Key, std::tuple<T...>>
+    : pick<std::tuple<T...>, typename stable_order<indices<Key<T>::value...>>::type> {};
+    template <template <typename> class Key, typename List>
+    using SortBy = typename sort_by<Key, List>::type;
+
+    // the elements that satisfy a predicate, in their order: those are the ones that a stable
+    // sort puts first
+    template <template <typename> class Predicate, typename List>
+    struct filter;
+    template <template <typename> class Predicate, typename... T>
+    struct filter<Predicate, std::tuple<T...>>
+    : pick<std::tuple<T...>,
+           Slice<typename stable_order<indices<Predicate<T>::value...>>::type, 0,
+                 sum<Predicate<T>::value...>::value>> {};
+    template <template <typename> class Predicate, typename List>
+    using Filter = typename filter<Predicate, List>::type;
 
     // compute alignments
     template <typename T>
     struct alignof_indexed;
     template <typename T, std::size_t I>
-    struct alignof_indexed<indexed<T, I>> : std::alignment_of<member<T>> {};
- 
-    // find maximum alignment
-    template <typename List>
-    struct max_alignment;
-    template <typename... T>
-    struct max_alignment<std::tuple<T...>> : max<alignof_indexed<T>::value...> {};
-
-    // Cons all the types with a given alignment into an accumulator
-    template <std::size_t Align, typename Acc, typename List>
-    struct cons_alignment : identity<Acc> {};
-    template <std::size_t Align, typename Acc, typename Head, typename... Tail>
-    struct cons_alignment<Align, Acc, std::tuple<Head, Tail...>>
-    : cons_alignment<
-        Align,
-        Conditional<Bool<alignof_indexed<Head>::value == Align>, Cons<Head, Acc>, Acc>,
-        std::tuple<Tail...>> {};
-    template <std::size_t Align, typename Acc, typename List>
-    using ConsAlignment = typename cons_alignment<Align, Acc, List>::type;
-
-    // Sort by iterating down from the maximum alignment
-    template <std::size_t Align, typename Acc, typename List>
-    struct sort_impl
-    : sort_impl<Align / 2, ConsAlignment<Align, Acc, List>, List> {};
-    template <typename Acc, typename List>
-    struct sort_impl<0, Acc, List> : identity<Acc> {};
+    struct alignof_indexed<indexed<T, I>> : std::alignment_of<member<Unannotated<T>>> {};
 
+    // Sort by decreasing alignment, keeping the interface order among equals
     template <typename List>
-    struct sort : sort_impl<max_alignment<List>::value, std::tuple<>, List> {};
+    struct sort : sort_by<alignof_indexed, List> {};
     template <typename List>
     using Sort = typename sort<List>::type;
 
@@ -189,104 +451,1092 @@ namespace my {
     struct split;
     template <typename... T, std::size_t... I>
     struct split<std::tuple<indexed<T, I>...>> {
-        using tuple = std::tuple<T...>;
+        using tuple = std::tuple<Unannotated<T>...>;
         using map = indices<I...>;
     };
 
     // Reversing the map
+    template <typename Map>
+    struct map_to_storage : inverse_map<Map> {};
+
+    // Layout policies
+    //
+    // A layout policy picks the storage order. It is a metafunction class that takes the list
+    // of indexed elements and gives it back reordered.
+    template <typename... Lists>
+    struct concat;
+    template <>
+    struct concat<> : identity<std::tuple<>> {};
+    template <typename... T>
+    struct concat<std::tuple<T...>> : identity<std::tuple<T...>> {};
+    template <typename... T, typename... U, typename... Rest>
+    struct concat<std::tuple<T...>, std::tuple<U...>, Rest...>
+    : concat<std::tuple<T..., U...>, Rest...> {};
+    template <typename... Lists>
+    using Concat = typename concat<Lists...>::type;
+
+    template <std::size_t N, std::size_t Align>
+    using RoundUp = index<(N + Align - 1) / Align * Align>;
+    constexpr std::size_t round_up(std::size_t n, std::size_t align) {
+        return (n + align - 1) / align * align;
+    }
+
+    template <typename T>
+    struct sizeof_indexed;
+    template <typename T, std::size_t I>
+    struct sizeof_indexed<indexed<T, I>> : index<sizeof(member<Unannotated<T>>)> {};
+
+    template <typename T>
+    struct is_stored_indexed;
+    template <typename T, std::size_t I>
+    struct is_stored_indexed<indexed<T, I>> : Bool<!is_empty_element<Unannotated<T>>::value> {};
+
+    // where the elements with the same alignment as the one at First stop
+    template <typename List, std::size_t First = 0>
+    struct run_end;
+    template <typename... T, std::size_t First>
+    struct run_end<std::tuple<T...>, First> {
+    private:
+        using aligns = index_array<indices<alignof_indexed<T>::value...>>;
+
+    public:
+        static constexpr std::size_t value = find_other(aligns::values, aligns::values[First], First, sizeof...(T));
+    };
+
+    // where the elements from First on stop needing no more alignment than the one before
+    template <typename List, std::size_t First = 0>
+    struct segment_end;
+    template <typename... T, std::size_t First>
+    struct segment_end<std::tuple<T...>, First> {
+    private:
+        using aligns = index_array<indices<alignof_indexed<T>::value...>>;
+
+    public:
+        static constexpr std::size_t value = First < sizeof...(T)? find_rise(aligns::values, First + 1, sizeof...(T)) : sizeof...(T);
+    };
+
+    // Offset of the element at position k of the nested storage (see below), given the
+    // alignments and sizes of the non-empty elements in storage order; for k == n, where the
+    // last one ends. Within a segment the elements are back to back, and each segment starts
+    // where the one before it ends, rounded up for both.
+    constexpr std::size_t segment_offset(std::size_t const* aligns, std::size_t const* sizes, std::size_t n,
+                                         std::size_t k, std::size_t first, std::size_t end, std::size_t base) {
+        return k < end || end == n? base + array_sum(sizes, first, k)
+             : segment_offset(aligns, sizes, n, k, end, find_rise(aligns, end + 1, n),
+                              round_up(round_up(base + array_sum(sizes, first, end), array_max(aligns, first, end)),
+                                       array_max(aligns, end, n)));
+    }
+    constexpr std::size_t storage_offset(std::size_t const* aligns, std::size_t const* sizes, std::size_t n, std::size_t k) {
+        return n == 0? 0 : segment_offset(aligns, sizes, n, k, 0, find_rise(aligns, 1, n), 0);
+    }
+
+    // Decreasing alignment is as small as it gets: sizes are multiples of alignments and
+    // alignments are powers of two, so every element ends where the next one can start.
+    struct by_alignment {
+        template <typename List>
+        struct apply : sort<List> {};
+    };
+
+    // Elements annotated as hot<T> go in the leading cache line. Decreasing alignment with the
+    // hot elements first among equals usually gets them there already, without any padding.
+    // When it does not, the hot elements go first, and cold elements fill the gap after them
+    // (see below).
+    constexpr std::size_t cache_line_size = 64;
+
+    template <typename T>
+    struct is_hot : Bool<false> {};
+    template <typename T>
+    struct is_hot<hot<T>> : Bool<true> {};
+    template <typename T, std::size_t I>
+    struct is_hot<indexed<T, I>> : is_hot<T> {};
+    template <typename T>
+    struct is_cold : Bool<!is_hot<T>::value> {};
+
+    // the size of the nested storage for a list of indexed elements, and where its last hot
+    // element ends
+    template <typename List, typename Positions = IndicesFor<List>>
+    struct storage_layout;
+    template <typename... T, std::size_t... J>
+    struct storage_layout<std::tuple<T...>, indices<J...>> {
+    private:
+        static constexpr std::size_t n = sizeof...(T);
+        using aligns = index_array<indices<alignof_indexed<T>::value...>>;
+        using sizes = index_array<indices<sizeof_indexed<T>::value...>>;
+
+    public:
+        static constexpr std::size_t size =
+            round_up(storage_offset(aligns::values, sizes::values, n, n), max<1, alignof_indexed<T>::value...>::value);
+        static constexpr std::size_t hot_end =
+            max<(is_hot<T>::value? storage_offset(aligns::values, sizes::values, n, J) + sizeof_indexed<T>::value : 0)...>::value;
+    };
     template <typename List>
-    struct inherit_all;
+    using StorageLayout = storage_layout<Filter<is_stored_indexed, List>>;
+
+    template <typename List>
+    struct list_align;
     template <typename... T>
-    struct inherit_all<std::tuple<T...>> : T... {};
+    struct list_align<std::tuple<T...>> : max<1, alignof_indexed<T>::value...> {};
+    // the smallest alignment among the hot elements, as the complement of the largest complement
+    template <typename List>
+    struct hot_align;
+    template <typename... T>
+    struct hot_align<std::tuple<T...>>
+    : index<~max<((is_hot<T>::value && is_stored_indexed<T>::value)? ~alignof_indexed<T>::value : 0)...>::value> {};
+    template <typename List>
+    struct hot_size;
+    template <typename... T>
+    struct hot_size<std::tuple<T...>>
+    : sum<((is_hot<T>::value && is_stored_indexed<T>::value)? sizeof_indexed<T>::value : 0)...> {};
+
+    // Filling the gap after the hot elements
+    //
+    // The hot elements go in a leading segment, together with some cold ones, and the rest
+    // follow by decreasing alignment. If that segment ends at a multiple of the largest
+    // alignment, nothing is padded. Each cold element in it adds its size to the remainder,
+    // and pushes the hot elements by its size if it needs more alignment than some of them, so
+    // picking the cold elements is a subset sum over the remainders, with the room left in the
+    // cache line as the budget. The cheapest push for each remainder is tabled over halves of
+    // the list, and the picks are found going down the same halves.
+    constexpr std::size_t smaller(std::size_t a, std::size_t b) {
+        return b < a? b : a;
+    }
+    constexpr std::size_t capped_sum(std::size_t a, std::size_t b, std::size_t cap) {
+        return a < cap && b < cap - a? a + b : cap;
+    }
+    // the cheapest way for two halves to reach remainder r, over the remainders [first, last)
+    // of the first half
+    constexpr std::size_t split_cost(std::size_t const* left, std::size_t const* right, std::size_t m,
+                                     std::size_t r, std::size_t cap, std::size_t first, std::size_t last) {
+        return last - first == 1? capped_sum(left[first], right[(r + m - first) % m], cap)
+             : smaller(split_cost(left, right, m, r, cap, first, midpoint(first, last)),
+                       split_cost(left, right, m, r, cap, midpoint(first, last), last));
+    }
+    // the first remainder of the first half in [first, last) that reaches r at that cost, or last
+    constexpr std::size_t find_split(std::size_t const* left, std::size_t const* right, std::size_t m,
+                                     std::size_t r, std::size_t cap, std::size_t cost, std::size_t first, std::size_t last) {
+        return last - first == 1? (capped_sum(left[first], right[(r + m - first) % m], cap) == cost? first : last)
+             : found_either(find_split(left, right, m, r, cap, cost, first, midpoint(first, last)), midpoint(first, last),
+                            find_split(left, right, m, r, cap, cost, midpoint(first, last), last));
+    }
+    constexpr std::size_t single_cost(std::size_t remainder, std::size_t push, std::size_t r, std::size_t cap) {
+        return r == 0? 0 : remainder == r? smaller(push, cap) : cap;
+    }
+
+    // the padding after the leading segment for each remainder, or m if it is out of budget
+    constexpr std::size_t gap_padding(std::size_t const* costs, std::size_t m, std::size_t hot, std::size_t cap, std::size_t r) {
+        return costs[r] < cap? (m - (hot + r) % m) % m : m;
+    }
+    constexpr std::size_t least_padding(std::size_t const* costs, std::size_t m, std::size_t hot, std::size_t cap,
+                                        std::size_t first, std::size_t last) {
+        return last - first == 1? gap_padding(costs, m, hot, cap, first)
+             : smaller(least_padding(costs, m, hot, cap, first, midpoint(first, last)),
+                       least_padding(costs, m, hot, cap, midpoint(first, last), last));
+    }
+    constexpr std::size_t find_padding(std::size_t const* costs, std::size_t m, std::size_t hot, std::size_t cap,
+                                       std::size_t padding, std::size_t first, std::size_t last) {
+        return last - first == 1? (gap_padding(costs, m, hot, cap, first) == padding? first : last)
+             : found_either(find_padding(costs, m, hot, cap, padding, first, midpoint(first, last)), midpoint(first, last),
+                            find_padding(costs, m, hot, cap, padding, midpoint(first, last), last));
+    }
 
-    template <typename T, std::size_t I, std::size_t J>
-    using indexed2 = indexed<indexed<T, I>, J>;
+    // the cheapest push for each remainder over the elements [First, First + Count)
+    template <typename Fill, std::size_t First, std::size_t Count, typename Remainders = IndicesUpTo<Fill::align>>
+    struct gap_costs;
+    template <typename Fill, std::size_t First, std::size_t Count, std::size_t... R>
+    struct gap_costs<Fill, First, Count, indices<R...>> {
+        using left = gap_costs<Fill, First, Count / 2>;
+        using right = gap_costs<Fill, First + Count / 2, Count - Count / 2>;
+        using type = indices<split_cost(index_array<typename left::type>::values, index_array<typename right::type>::values,
+                                        Fill::align, R, Fill::cap, 0, Fill::align)...>;
+    };
+    template <typename Fill, std::size_t First, std::size_t... R>
+    struct gap_costs<Fill, First, 1, indices<R...>> {
+        using type = indices<single_cost(index_array<typename Fill::remainders>::values[First],
+                                         index_array<typename Fill::pushes>::values[First], R, Fill::cap)...>;
+    };
 
-    template <std::size_t Target, std::size_t Result, typename T>
-    index<Result> find_index_impl(indexed2<T, Target, Result> const&);
+    // whether element I goes in the leading segment, when [First, First + Count) reaches remainder R
+    template <typename Fill, std::size_t I, std::size_t R, std::size_t First, std::size_t Count>
+    struct gap_pick {
+    private:
+        using left = gap_costs<Fill, First, Count / 2>;
+        using right = gap_costs<Fill, First + Count / 2, Count - Count / 2>;
+        static constexpr std::size_t split =
+            find_split(index_array<typename left::type>::values, index_array<typename right::type>::values, Fill::align, R, Fill::cap,
+                       index_array<typename gap_costs<Fill, First, Count>::type>::values[R], 0, Fill::align);
 
-    template <std::size_t N, typename List>
-    using find_index = decltype(find_index_impl<N>(inherit_all<List>{}));
+    public:
+        static constexpr bool value =
+            Conditional<Bool<(I < First + Count / 2)>,
+                        gap_pick<Fill, I, split, First, Count / 2>,
+                        gap_pick<Fill, I, (R + Fill::align - split) % Fill::align, First + Count / 2, Count - Count / 2>>::value;
+    };
+    template <typename Fill, std::size_t I, std::size_t R, std::size_t First>
+    struct gap_pick<Fill, I, R, First, 1> : Bool<R != 0> {};
 
-    template <typename List, typename Indices = IndicesFor<List>>
-    struct map_to_storage {};
-    template <typename List, std::size_t... I>
-    struct map_to_storage<List, indices<I...>>
-    : identity<indices<find_index<I, List>::value...>> {};
+    template <typename List>
+    struct gap_fill;
+    template <typename... T>
+    struct gap_fill<std::tuple<T...>> {
+        static constexpr std::size_t align = list_align<std::tuple<T...>>::value;
+        static constexpr std::size_t hot = hot_size<std::tuple<T...>>::value;
+        static constexpr std::size_t cap = hot <= cache_line_size? cache_line_size - hot + 1 : 1;
 
-    // All the optimal layout info
+        using remainders = indices<((is_cold<T>::value && is_stored_indexed<T>::value)? sizeof_indexed<T>::value % align : 0)...>;
+        using pushes = indices<(alignof_indexed<T>::value > hot_align<std::tuple<T...>>::value? sizeof_indexed<T>::value : 0)...>;
+    };
+
+    // the remainder that leaves the least padding within budget
     template <typename List>
+    struct gap_remainder {
+    private:
+        using fill = gap_fill<List>;
+        using costs = index_array<typename gap_costs<fill, 0, std::tuple_size<List>::value>::type>;
+        static constexpr std::size_t padding = least_padding(costs::values, fill::align, fill::hot, fill::cap, 0, fill::align);
+
+    public:
+        static constexpr std::size_t value = find_padding(costs::values, fill::align, fill::hot, fill::cap, padding, 0, fill::align);
+    };
+
+    constexpr std::size_t first_key_bit = ~(~std::size_t(0) >> 1);
+
+    // decreasing alignment with hot first among equals, or the same with the leading segment first
+    template <typename T>
+    struct packed_key : index<alignof_indexed<T>::value * 2 + is_hot<T>::value> {};
+    template <typename List>
+    struct filled_key {
+        template <typename T>
+        struct apply;
+        template <typename T, std::size_t I>
+        struct apply<indexed<T, I>>
+        : index<((is_hot<T>::value || gap_pick<gap_fill<List>, I, gap_remainder<List>::value, 0, std::tuple_size<List>::value>::value)?
+                     first_key_bit + packed_key<indexed<T, I>>::value
+                     : alignof_indexed<indexed<T, I>>::value)> {};
+    };
+
+    template <typename List>
+    struct std_tuple_size;
+    template <typename... T, std::size_t... I>
+    struct std_tuple_size<std::tuple<indexed<T, I>...>> : index<sizeof(std::tuple<Unannotated<T>...>)> {};
+
+    struct hot_cold {
+        template <typename List,
+                  typename Packed = SortBy<packed_key, List>,
+                  typename Filled = SortBy<filled_key<List>::template apply, List>,
+                  typename Order = Conditional<Bool<(StorageLayout<Packed>::hot_end <= cache_line_size)>, Packed, Filled>>
+        struct apply : identity<Order> {
+            static_assert(hot_size<List>::value <= cache_line_size,
+                "hot elements do not fit in a cache line");
+            static_assert(StorageLayout<Order>::size <= std_tuple_size<List>::value,
+                "hot elements do not fit in a cache line without making the tuple larger than std::tuple");
+        };
+    };
+
+    // The policy for a given list of elements. The default sorts by alignment, unless some
+    // elements are annotated as hot. Specialize to pick another one.
+    template <typename... T>
+    struct layout_policy
+    : identity<Conditional<All<is_cold<T>...>, by_alignment, hot_cold>> {};
+    template <typename... T>
+    using LayoutPolicy = typename layout_policy<T...>::type;
+
+    // All the optimal layout info
+    template <typename List, typename Policy = by_alignment>
     struct optimal_order {
-        using sorted = Sort<WithIndices<List>>;
+        using sorted = typename Policy::template apply<WithIndices<List>>::type;
         using tuple = typename split<sorted>::tuple;
         using to_interface = typename split<sorted>::map;
-        using to_storage = typename map_to_storage<WithIndices<sorted>>::type;
+        using to_storage = typename map_to_storage<to_interface>::type;
     };
 
     template <typename... T>
-    using OptimalStorage = typename optimal_order<std::tuple<T...>>::tuple;
+    using OptimalStorage = typename optimal_order<std::tuple<T...>, LayoutPolicy<T...>>::tuple;
     template <typename... T>
-    using MapToInterface = typename optimal_order<std::tuple<T...>>::to_interface;
+    using MapToInterface = typename optimal_order<std::tuple<T...>, LayoutPolicy<T...>>::to_interface;
     template <typename... T>
-    using MapToStorage = typename optimal_order<std::tuple<T...>>::to_storage;
+    using MapToStorage = typename optimal_order<std::tuple<T...>, LayoutPolicy<T...>>::to_storage;
+
+    // getting elements with std::get or whatever ADL finds
+    namespace get_adl {
+        using std::get;
+        template <std::size_t I, typename Tuple>
+        auto get_element(Tuple&& t) -> decltype(get<I>(std::forward<Tuple>(t))) {
+            return get<I>(std::forward<Tuple>(t));
+        }
+    } // namespace get_adl
 
+    // references to the elements of a tuple, in the order given by a map; the types come
+    // straight from get, instead of looking up each element in the whole list
     template <typename Tuple, std::size_t... I>
-    using ShuffleTuple = std::tuple<TupleElement<I, Decay<Tuple>>...>;
-    
+    using ShuffleTuple = std::tuple<decltype(get_adl::get_element<I>(std::declval<Tuple>()))...>;
+
     template <std::size_t... I, typename Tuple>
     ShuffleTuple<Tuple, I...> forward_shuffled_tuple(indices<I...>, Tuple&& t) {
-        using std::get;
-        return std::forward_as_tuple(get<I>(std::forward<Tuple>(t))...);
+        return ShuffleTuple<Tuple, I...>(get_adl::get_element<I>(std::forward<Tuple>(t))...);
     }
     template <std::size_t... I, typename... T>
     ShuffleTuple<std::tuple<T&&...>, I...> forward_shuffled(indices<I...> map, T&&... t) {
         return forward_shuffled_tuple(map, std::forward_as_tuple(std::forward<T>(t)...));
     }
 
-    // GCC needs another goat sacrifice
+    // GCC needs another goat sacrifice: the packs are only expanded together once their sizes
+    // are known to match
+    template <typename Ts, typename Us>
+    struct all_convertible;
+    template <typename... T, typename... U>
+    struct all_convertible<std::tuple<T...>, std::tuple<U...>> : All<std::is_convertible<T, U>...> {};
     template <typename Ts, typename Us>
     struct pairwise_convertible : Bool<false> {};
-    template <>
-    struct pairwise_convertible<std::tuple<>, std::tuple<>> : Bool<true> {};
-    template <typename THead, typename... TTail, typename UHead, typename... UTail>
-    struct pairwise_convertible<std::tuple<THead, TTail...>, std::tuple<UHead, UTail...>>
-    : All<std::is_convertible<THead, UHead>, pairwise_convertible<std::tuple<TTail...>, std::tuple<UTail...>>> {};
+    template <typename... T, typename... U>
+    struct pairwise_convertible<std::tuple<T...>, std::tuple<U...>>
+    : Conditional<Bool<sizeof...(T) == sizeof...(U)>, all_convertible<std::tuple<T...>, std::tuple<U...>>, Bool<false>> {};
+    template <typename Ts, typename Us>
+    struct all_constructible;
+    template <typename... T, typename... U>
+    struct all_constructible<std::tuple<T...>, std::tuple<U...>> : All<std::is_constructible<U, T>...> {};
+    template <typename Ts, typename Us>
+    struct pairwise_constructible : Bool<false> {};
+    template <typename... T, typename... U>
+    struct pairwise_constructible<std::tuple<T...>, std::tuple<U...>>
+    : Conditional<Bool<sizeof...(T) == sizeof...(U)>, all_constructible<std::tuple<T...>, std::tuple<U...>>, Bool<false>> {};
+
+    // Storage
+    //
+    // The elements are kept in storage order as nested members. With alignments decreasing
+    // along the way, each one lands at the same offset it would have as a member of a plain
+    // struct, without relying on how the standard library lays out its tuple. Because there is
+    // nothing else in there, the storage is trivially copyable, trivially destructible, and
+    // standard-layout whenever all the elements are. Empty elements are stored as bases
+    // instead, so that they take no space.
+    //
+    // Elements with the same alignment in a row form a run, nested as a balanced tree, and
+    // each run holds the next one after it. Reaching an element takes a step per run before
+    // it and logarithmically many inside its run, instead of a step per element before it.
+    //
+    // Nesting a run that needs more alignment would pad the one before it to that alignment,
+    // so a layout policy that lets alignment rise gets a segment for each stretch where it
+    // does not. Each segment holds its runs as above, and the next segment after them, so
+    // that padding only goes where the alignment rises.
+
+    // uses-allocator construction, as arguments for a piecewise constructor
+    template <typename T, typename Alloc, typename... U>
+    using UsesAllocatorTag = index<
+        !std::uses_allocator<T, Alloc>::value? 0
+        : std::is_constructible<T, std::allocator_arg_t, Alloc const&, U...>::value? 1
+        : 2>;
+
+    template <typename Alloc, typename... U>
+    std::tuple<U&&...> uses_allocator_args_impl(index<0>, Alloc const&, U&&... u) {
+        return std::forward_as_tuple(std::forward<U>(u)...);
+    }
+    template <typename Alloc, typename... U>
+    std::tuple<std::allocator_arg_t const&, Alloc const&, U&&...> uses_allocator_args_impl(index<1>, Alloc const& a, U&&... u) {
+        return std::forward_as_tuple(std::allocator_arg, a, std::forward<U>(u)...);
+    }
+    template <typename Alloc, typename... U>
+    std::tuple<U&&..., Alloc const&> uses_allocator_args_impl(index<2>, Alloc const& a, U&&... u) {
+        return std::forward_as_tuple(std::forward<U>(u)..., a);
+    }
+    template <typename T, typename Alloc, typename... U>
+    auto uses_allocator_args(Alloc const& a, U&&... u)
+    -> decltype(uses_allocator_args_impl(UsesAllocatorTag<T, Alloc, U...>{}, a, std::forward<U>(u)...)) {
+        return uses_allocator_args_impl(UsesAllocatorTag<T, Alloc, U...>{}, a, std::forward<U>(u)...);
+    }
+
+    // a single non-empty element
+    template <typename T>
+    struct element {
+        T value;
+
+        constexpr element() : value() {}
+        template <typename... Args>
+        constexpr element(std::piecewise_construct_t, std::tuple<Args...>&& args)
+        : element(std::move(args), IndicesFor<std::tuple<Args...>>{}) {}
+
+    private:
+        template <typename... Args, std::size_t... I>
+        constexpr element(std::tuple<Args...>&& args, indices<I...>)
+        : value(std::get<I>(std::move(args))...) {}
+    };
+    // references assign through
+    template <typename T>
+    struct element<T&> {
+        T& value;
+
+        template <typename... Args>
+        constexpr element(std::piecewise_construct_t, std::tuple<Args...>&& args)
+        : element(std::move(args), IndicesFor<std::tuple<Args...>>{}) {}
+
+        element(element const&) = default;
+        element& operator=(element const& that) {
+            value = that.value;
+            return *this;
+        }
+
+    private:
+        template <typename... Args, std::size_t... I>
+        constexpr element(std::tuple<Args...>&& args, indices<I...>)
+        : value(std::get<I>(std::move(args))...) {}
+    };
+    template <typename T>
+    struct element<T&&> {
+        T&& value;
+
+        template <typename... Args>
+        constexpr element(std::piecewise_construct_t, std::tuple<Args...>&& args)
+        : element(std::move(args), IndicesFor<std::tuple<Args...>>{}) {}
+
+        element(element&&) = default;
+        element& operator=(element const& that) {
+            value = that.value;
+            return *this;
+        }
+        element& operator=(element&& that) {
+            value = std::forward<T>(that.value);
+            return *this;
+        }
+
+    private:
+        template <typename... Args, std::size_t... I>
+        constexpr element(std::tuple<Args...>&& args, indices<I...>)
+        : value(std::get<I>(std::move(args))...) {}
+    };
+
+    // A single empty element. The held list and the index make each holder unique to its tuple,
+    // so that nested tuples holding the same empty types never share a base. The element is a
+    // member, so that its member names do not reach the tuple; without [[no_unique_address]] it
+    // has to be a base to take no space.
+#if defined(MY_TUPLE_NO_UNIQUE_ADDRESS)
+    template <typename Sorted, std::size_t S, typename T>
+    struct empty_element {
+        constexpr empty_element() : value() {}
+        template <typename... Args>
+        constexpr empty_element(std::piecewise_construct_t, std::tuple<Args...>&& args)
+        : empty_element(std::move(args), IndicesFor<std::tuple<Args...>>{}) {}
+
+        T& held() noexcept { return value; }
+
+    private:
+        template <typename... Args, std::size_t... I>
+        constexpr empty_element(std::tuple<Args...>&& args, indices<I...>)
+        : value(std::get<I>(std::move(args))...) {}
+
+        [[__no_unique_address__]] T value;
+    };
+#else
+    template <typename Sorted, std::size_t S, typename T>
+    struct empty_element : private T {
+        constexpr empty_element() : T() {}
+        template <typename... Args>
+        constexpr empty_element(std::piecewise_construct_t, std::tuple<Args...>&& args)
+        : empty_element(std::move(args), IndicesFor<std::tuple<Args...>>{}) {}
+
+        T& held() noexcept { return *this; }
+
+    private:
+        template <typename... Args, std::size_t... I>
+        constexpr empty_element(std::tuple<Args...>&& args, indices<I...>)
+        : T(std::get<I>(std::move(args))...) {}
+    };
+#endif
+
+    // what the elements are constructed from, by storage position
+    template <typename Refs>
+    struct refs_source {
+        Refs& refs;
+
+        template <std::size_t S, typename T>
+        constexpr auto args() const -> decltype(std::forward_as_tuple(std::get<S>(std::declval<Refs>()))) {
+            return std::forward_as_tuple(std::get<S>(static_cast<Refs&&>(refs)));
+        }
+    };
+    template <typename Alloc>
+    struct alloc_source {
+        Alloc const& a;
+
+        template <std::size_t S, typename T>
+        auto args() const -> decltype(uses_allocator_args<T>(std::declval<Alloc const&>())) {
+            return uses_allocator_args<T>(a);
+        }
+    };
+    template <typename Alloc, typename Refs>
+    struct alloc_refs_source {
+        Alloc const& a;
+        Refs& refs;
+
+        template <std::size_t S, typename T>
+        auto args() const
+        -> decltype(uses_allocator_args<T>(std::declval<Alloc const&>(), std::get<S>(std::declval<Refs>()))) {
+            return uses_allocator_args<T>(a, std::get<S>(static_cast<Refs&&>(refs)));
+        }
+    };
+
+    // A run of non-empty elements with the same alignment, as a balanced tree over the
+    // positions [First, First + Size) of a held list. The list has each element type indexed
+    // with its storage position; all the nodes share it, instead of splitting it up.
+    template <typename Elements, std::size_t First, std::size_t Size>
+    struct run {
+        using left_type = run<Elements, First, Size / 2>;
+        using right_type = run<Elements, First + Size / 2, Size - Size / 2>;
+        static constexpr std::size_t first = left_type::first;
+
+        left_type left;
+        right_type right;
+
+        constexpr run() = default;
+        template <typename Source>
+        constexpr run(std::piecewise_construct_t p, Source const& source)
+        : left(p, source), right(p, source) {}
+
+        template <std::size_t S, typename T>
+        static T& at(run& r) noexcept {
+            return at<S, T>(r, Bool<(S < right_type::first)>{});
+        }
+
+    private:
+        template <std::size_t S, typename T>
+        static T& at(run& r, Bool<true>) noexcept {
+            return left_type::template at<S, T>(r.left);
+        }
+        template <std::size_t S, typename T>
+        static T& at(run& r, Bool<false>) noexcept {
+            return right_type::template at<S, T>(r.right);
+        }
+    };
+    template <typename Elements, std::size_t First>
+    struct run<Elements, First, 1> {
+        using element_type = typename HeldElement<First, Elements>::type;
+        static constexpr std::size_t first = HeldElement<First, Elements>::i;
+
+        element<element_type> leaf;
+
+        constexpr run() = default;
+        template <typename Source>
+        constexpr run(std::piecewise_construct_t p, Source const& source)
+        : leaf(p, source.template args<first, element_type>()) {}
+
+        template <std::size_t, typename T>
+        static T& at(run& r) noexcept {
+            return r.leaf.value;
+        }
+    };
+
+    // the runs of a segment, each nested in the previous one
+    template <typename Elements,
+              std::size_t First = 0,
+              std::size_t End = run_end<typename Elements::list, First>::value,
+              std::size_t Size = std::tuple_size<typename Elements::list>::value>
+    struct chain {
+        using head_type = run<Elements, First, End - First>;
+        using tail_type = chain<Elements, End, run_end<typename Elements::list, End>::value, Size>;
+        static constexpr std::size_t first = head_type::first;
+
+        head_type head;
+        tail_type tail;
+
+        constexpr chain() = default;
+        template <typename Source>
+        constexpr chain(std::piecewise_construct_t p, Source const& source)
+        : head(p, source), tail(p, source) {}
+
+        template <std::size_t S, typename T>
+        static T& at(chain& c) noexcept {
+            return at<S, T>(c, Bool<(S < tail_type::first)>{});
+        }
+
+    private:
+        template <std::size_t S, typename T>
+        static T& at(chain& c, Bool<true>) noexcept {
+            return head_type::template at<S, T>(c.head);
+        }
+        template <std::size_t S, typename T>
+        static T& at(chain& c, Bool<false>) noexcept {
+            return tail_type::template at<S, T>(c.tail);
+        }
+    };
+    template <typename Elements, std::size_t First, std::size_t Size>
+    struct chain<Elements, First, Size, Size> {
+        using head_type = run<Elements, First, Size - First>;
+        static constexpr std::size_t first = head_type::first;
+
+        head_type head;
+
+        constexpr chain() = default;
+        template <typename Source>
+        constexpr chain(std::piecewise_construct_t p, Source const& source)
+        : head(p, source) {}
+
+        template <std::size_t S, typename T>
+        static T& at(chain& c) noexcept {
+            return head_type::template at<S, T>(c.head);
+        }
+    };
+    template <typename Elements>
+    struct chain<Elements, 0, 0, 0> {
+        constexpr chain() = default;
+        template <typename Source>
+        constexpr chain(std::piecewise_construct_t, Source const&) {}
+    };
+
+    // the segments, each nested in the previous one
+    template <typename Elements,
+              std::size_t First = 0,
+              std::size_t End = segment_end<typename Elements::list, First>::value,
+              std::size_t Size = std::tuple_size<typename Elements::list>::value>
+    struct segments {
+        using head_type = chain<Elements, First, run_end<typename Elements::list, First>::value, End>;
+        using tail_type = segments<Elements, End>;
+        static constexpr std::size_t first = head_type::first;
+
+        head_type head;
+        tail_type tail;
+
+        constexpr segments() = default;
+        template <typename Source>
+        constexpr segments(std::piecewise_construct_t p, Source const& source)
+        : head(p, source), tail(p, source) {}
+
+        template <std::size_t S, typename T>
+        static T& at(segments& s) noexcept {
+            return at<S, T>(s, Bool<(S < tail_type::first)>{});
+        }
+
+    private:
+        template <std::size_t S, typename T>
+        static T& at(segments& s, Bool<true>) noexcept {
+            return head_type::template at<S, T>(s.head);
+        }
+        template <std::size_t S, typename T>
+        static T& at(segments& s, Bool<false>) noexcept {
+            return tail_type::template at<S, T>(s.tail);
+        }
+    };
+    template <typename Elements, std::size_t First, std::size_t Size>
+    struct segments<Elements, First, Size, Size>
+    : chain<Elements, First, run_end<typename Elements::list, First>::value, Size> {
+        using chain<Elements, First, run_end<typename Elements::list, First>::value, Size>::chain;
+    };
+
+    // splitting storage positions into empty and non-empty elements
+    template <typename List>
+    struct partition_empty;
+    template <typename... T>
+    struct partition_empty<std::tuple<T...>> {
+    private:
+        using order = typename stable_order<indices<is_empty_element<T>::value...>>::type;
+        static constexpr std::size_t empty_count = sum<is_empty_element<T>::value...>::value;
+
+    public:
+        using empty = Slice<order, 0, empty_count>;
+        using non_empty = Slice<order, empty_count, sizeof...(T) - empty_count>;
+    };
+
+    // swapping with std::swap or whatever ADL finds
+    namespace swap_adl {
+        using std::swap;
+        template <typename T>
+        struct is_nothrow_swappable : Bool<noexcept(swap(std::declval<T&>(), std::declval<T&>()))> {};
+    } // namespace swap_adl
+    using swap_adl::is_nothrow_swappable;
+
+    // tag for constructing from a tuple of references in storage order
+    struct storage_order_t {};
+
+    // Equality and hashing
+    //
+    // Some elements are equal exactly when their bytes are. When several of them lie back to
+    // back in storage, the whole block is compared and hashed as one span of bytes, instead
+    // of one element at a time.
+    //
+    // Elements are back to back within a run, since their sizes are multiples of their common
+    // alignment. Across runs they are too, as long as no element further along the chain needs
+    // more alignment than the one before, because then no run gets padded to a larger
+    // alignment. Other gaps are assumed to hold padding.
+    //
+    // Empty elements have no bytes, but they still compare with their own equality; they are
+    // only left out of hashes.
+
+    // Specialize for other types whose equality compares all of their bytes, and that have no
+    // padding.
+    template <typename T>
+    struct is_bitwise_comparable
+    : Bool<std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value> {};
+
+    // the position after k if alignment increases there, or zero; the largest one is where the
+    // alignment stops increasing for good
+    constexpr std::size_t rise_after(std::size_t const* aligns, std::size_t n, std::size_t k) {
+        return k + 1 < n && aligns[k] < aligns[k + 1]? k + 1 : 0;
+    }
+    // whether the element at k shares a block with the next one
+    constexpr std::size_t joins_next(std::size_t const* aligns, std::size_t const* bitwise,
+                                     std::size_t rise, std::size_t n, std::size_t k) {
+        return k + 1 < n && bitwise[k] && bitwise[k + 1]
+            && (aligns[k] == aligns[k + 1] || (aligns[k] > aligns[k + 1] && k >= rise));
+    }
+
+    // whether the element at k starts a block
+    constexpr bool starts_block(std::size_t const* aligns, std::size_t const* bitwise,
+                                std::size_t rise, std::size_t n, std::size_t k) {
+        return k == 0 || !joins_next(aligns, bitwise, rise, n, k - 1);
+    }
+
+#if __cplusplus >= 201402L
+    // where each block starts and ends, in chain order
+    template <std::size_t N>
+    struct block_bounds {
+        std::size_t count;
+        std::size_t first[N + 1];
+        std::size_t last[N + 1];
+    };
+
+    // all the blocks in one pass
+    template <std::size_t... A, std::size_t... B>
+    constexpr block_bounds<sizeof...(A)> make_block_bounds(indices<A...>, indices<B...>) {
+        std::size_t const aligns[] = { A..., 0 };
+        std::size_t const bitwise[] = { B..., 0 };
+        constexpr std::size_t n = sizeof...(A);
+        std::size_t rise = 0;
+        for(std::size_t k = 0; k < n; ++k) {
+            rise = larger(rise, rise_after(aligns, n, k));
+        }
+        block_bounds<n> bounds {};
+        for(std::size_t k = 0; k < n; ++k) {
+            if(starts_block(aligns, bitwise, rise, n, k)) bounds.first[bounds.count] = k;
+            if(!joins_next(aligns, bitwise, rise, n, k)) bounds.last[bounds.count++] = k;
+        }
+        return bounds;
+    }
+
+    template <typename Aligns, typename Bitwise>
+    struct block_bounds_table {
+    private:
+        using bounds_type = block_bounds<std::tuple_size<Aligns>::value>;
+        static constexpr bounds_type value = make_block_bounds(Aligns{}, Bitwise{});
+
+    public:
+        static constexpr std::size_t count = value.count;
+        static constexpr std::size_t first(std::size_t j) { return value.first[j]; }
+        static constexpr std::size_t last(std::size_t j) { return value.last[j]; }
+    };
+    template <typename Aligns, typename Bitwise>
+    constexpr typename block_bounds_table<Aligns, Bitwise>::bounds_type block_bounds_table<Aligns, Bitwise>::value;
+#else
+    // the position of the j-th marked element in [first, last); the counts are taken over
+    // halves of halves of the whole array, so that the compiler can reuse them across j
+    constexpr std::size_t select_marked(std::size_t const* marks, std::size_t j, std::size_t first, std::size_t last) {
+        return last - first <= 1? first
+             : j < array_sum(marks, first, midpoint(first, last))? select_marked(marks, j, first, midpoint(first, last))
+             : select_marked(marks, j - array_sum(marks, first, midpoint(first, last)), midpoint(first, last), last);
+    }
+
+    // where each block starts and ends, in chain order: the starts are marked once for the
+    // whole list, and each block ends right before the next one starts
+    template <typename Aligns, typename Bitwise, typename Positions = IndicesFor<Aligns>>
+    struct block_bounds_table;
+    template <typename Aligns, typename Bitwise, std::size_t... K>
+    struct block_bounds_table<Aligns, Bitwise, indices<K...>> {
+    private:
+        static constexpr std::size_t n = sizeof...(K);
+        static constexpr std::size_t rise = max<rise_after(index_array<Aligns>::values, n, K)...>::value;
+        using starts = index_array<indices<
+            starts_block(index_array<Aligns>::values, index_array<Bitwise>::values, rise, n, K)...>>;
+
+    public:
+        static constexpr std::size_t count = array_sum(starts::values, 0, n);
+        static constexpr std::size_t first(std::size_t j) {
+            return select_marked(starts::values, j, 0, n);
+        }
+        static constexpr std::size_t last(std::size_t j) {
+            return (j + 1 < count? first(j + 1) : n) - 1;
+        }
+    };
+#endif
+
+    constexpr std::uint64_t hash_multiplier = 0x9e3779b97f4a7c15;
+
+    inline std::uint64_t hash_mix(std::uint64_t h, std::uint64_t v) {
+        h = (h ^ v) * hash_multiplier;
+        return h ^ (h >> 32);
+    }
+    // a word at a time, with the length mixed into the last one
+    inline std::uint64_t hash_bytes(std::uint64_t h, unsigned char const* bytes, std::size_t n) {
+        for(; n >= sizeof(std::uint64_t); bytes += sizeof(std::uint64_t), n -= sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, bytes, sizeof(word));
+            h = hash_mix(h, word);
+        }
+        if(n > 0) {
+            std::uint64_t word = std::uint64_t(n) << 56;
+            for(std::size_t i = 0; i < n; ++i) {
+                word ^= std::uint64_t(bytes[i]) << (8 * i);
+            }
+            h = hash_mix(h, word);
+        }
+        return h;
+    }
+
+    // Short blocks are folded a word at a time without branching, which compilers turn into
+    // a few vector loads and one test; longer ones go to memcmp, which can stop early.
+    constexpr std::size_t short_block_size = 64;
+
+    inline bool bytes_equal(unsigned char const* a, unsigned char const* b, std::size_t n) {
+        if(n > short_block_size) return std::memcmp(a, b, n) == 0;
+        std::uint64_t difference = 0;
+        for(; n >= sizeof(std::uint64_t); a += sizeof(std::uint64_t), b += sizeof(std::uint64_t), n -= sizeof(std::uint64_t)) {
+            std::uint64_t x, y;
+            std::memcpy(&x, a, sizeof(x));
+            std::memcpy(&y, b, sizeof(y));
+            difference |= x ^ y;
+        }
+        for(; n > 0; ++a, ++b, --n) {
+            difference |= *a ^ *b;
+        }
+        return difference == 0;
+    }
+
+    template <typename T>
+    unsigned char const* bytes_of(T const& t) noexcept {
+        return reinterpret_cast<unsigned char const*>(std::addressof(t));
+    }
+    // the bytes from the start of the element at S to the end of the element at Last
+    template <std::size_t S, std::size_t Last, typename Storage>
+    std::size_t block_size(Storage const& s) noexcept {
+        return bytes_of(s.template at<Last>()) + sizeof(s.template at<Last>()) - bytes_of(s.template at<S>());
+    }
+
+    // a block of one element is compared and hashed by itself
+    template <std::size_t S, std::size_t Last, typename Storage>
+    bool equal_block(Storage const& a, Storage const& b, Bool<true>) {
+        return a.template at<S>() == b.template at<S>();
+    }
+    template <std::size_t S, std::size_t Last, typename Storage>
+    bool equal_block(Storage const& a, Storage const& b, Bool<false>) {
+        return bytes_equal(bytes_of(a.template at<S>()), bytes_of(b.template at<S>()), block_size<S, Last>(a));
+    }
+
+    template <std::size_t S, std::size_t Last, typename Storage>
+    std::uint64_t hash_block(std::uint64_t h, Storage const& s, Bool<true>) {
+        using element_type = typename std::decay<decltype(s.template at<S>())>::type;
+        return hash_mix(h, std::hash<element_type>{}(s.template at<S>()));
+    }
+    template <std::size_t S, std::size_t Last, typename Storage>
+    std::uint64_t hash_block(std::uint64_t h, Storage const& s, Bool<false>) {
+        return hash_bytes(h, bytes_of(s.template at<S>()), block_size<S, Last>(s));
+    }
+
+    // The blocks among the non-empty elements of a held list, in chain order, as the storage
+    // positions where each one starts and ends. The bounds are worked out once for the whole
+    // list, from the alignments and comparability of its elements passed as plain lists, so
+    // that nothing goes through the held list again for each element or block.
+    template <typename Positions, typename Bounds, typename Blocks = IndicesUpTo<Bounds::count>>
+    struct block_positions;
+    template <typename Positions, typename Bounds, std::size_t... J>
+    struct block_positions<Positions, Bounds, indices<J...>> {
+        using firsts = indices<index_array<Positions>::values[Bounds::first(J)]...>;
+        using lasts = indices<index_array<Positions>::values[Bounds::last(J)]...>;
+    };
 
-    template <typename From, typename To>
-    struct convert_layout_map;
+    template <typename Sorted, typename NonEmpty = typename partition_empty<typename Sorted::list>::non_empty>
+    struct block_table;
+    template <typename Sorted, std::size_t... V>
+    struct block_table<Sorted, indices<V...>>
+    : block_positions<indices<V...>, block_bounds_table<
+        indices<std::alignment_of<member<HeldElement<V, Sorted>>>::value...>,
+        indices<is_bitwise_comparable<HeldElement<V, Sorted>>::value...>>> {};
+
+    template <typename Sorted,
+              typename Firsts = typename block_table<Sorted>::firsts,
+              typename Lasts = typename block_table<Sorted>::lasts>
+    struct bitwise_blocks;
+    template <typename Sorted, std::size_t... S, std::size_t... Last>
+    struct bitwise_blocks<Sorted, indices<S...>, indices<Last...>> {
+        template <typename Storage>
+        static bool equal(Storage const& a, Storage const& b) {
+            bool result = true;
+            (void)swallow{ 0, (result = result && equal_block<S, Last>(a, b, Bool<S == Last>{}), 0)... };
+            return result;
+        }
+
+        template <typename Storage>
+        static std::uint64_t hash(Storage const& s) {
+            std::uint64_t h = std::tuple_size<typename partition_empty<typename Sorted::list>::non_empty>::value;
+            (void)swallow{ 0, (h = hash_block<S, Last>(h, s, Bool<S == Last>{}), 0)... };
+            return h;
+        }
+    };
 
-    template <typename From, std::size_t... To>
-    struct convert_layout_map<From, indices<To...>>
-    //: identity<std::tuple<TupleElement<To, From>...>> {};
-    : identity<indices<TupleElement<To, From>::value...>> {};
+    // the empty elements, as bases of their own so that storage needs no long index lists
+    template <typename Sorted, typename Empty = typename partition_empty<typename Sorted::list>::empty>
+    struct empty_elements;
+    template <typename Sorted, std::size_t... E>
+    struct empty_elements<Sorted, indices<E...>> : empty_element<Sorted, E, HeldElement<E, Sorted>>... {
+        constexpr empty_elements() = default;
 
-    template <typename From, typename To>
-    using ConvertLayoutMap = typename convert_layout_map<From, To>::type;
+        template <typename Source>
+        constexpr empty_elements(std::piecewise_construct_t p, Source const& source)
+        : empty_element<Sorted, E, HeldElement<E, Sorted>>(p, source.template args<E, HeldElement<E, Sorted>>())... {}
+    };
+    template <typename Sorted>
+    struct empty_elements<Sorted, indices<>> {
+        constexpr empty_elements() = default;
+
+        template <typename Source>
+        constexpr empty_elements(std::piecewise_construct_t, Source const&) {}
+    };
+
+    // the segments holding the non-empty elements, under a root unique to the held list
+    template <typename Sorted, typename NonEmpty = typename partition_empty<typename Sorted::list>::non_empty>
+    struct non_empty_chain;
+    template <typename Sorted, std::size_t... V>
+    struct non_empty_chain<Sorted, indices<V...>>
+    : segments<Held<std::tuple<indexed<HeldElement<V, Sorted>, V>...>>> {
+    private:
+        using segments_type = segments<Held<std::tuple<indexed<HeldElement<V, Sorted>, V>...>>>;
+
+    public:
+        constexpr non_empty_chain() = default;
+        template <typename Source>
+        constexpr non_empty_chain(std::piecewise_construct_t p, Source const& source)
+        : segments_type(p, source) {}
+
+        template <std::size_t S, typename T>
+        static T& at(non_empty_chain& c) noexcept {
+            return segments_type::template at<S, T>(c);
+        }
+    };
+
+    // the elements in storage order, as a held list
+    template <typename Sorted>
+    struct storage : empty_elements<Sorted>, non_empty_chain<Sorted> {
+    private:
+        template <std::size_t S>
+        using Element = HeldElement<S, Sorted>;
+        template <std::size_t S>
+        using EmptyBase = empty_element<Sorted, S, Element<S>>;
+        using empty_type = empty_elements<Sorted>;
+        using chain_type = non_empty_chain<Sorted>;
+        using all_indices = IndicesFor<typename Sorted::list>;
+        using empty_indices = typename partition_empty<typename Sorted::list>::empty;
+
+        template <typename Source>
+        constexpr storage(std::piecewise_construct_t p, Source const& source)
+        : empty_type(p, source), chain_type(p, source) {}
+
+    public:
+        constexpr storage() = default;
+
+        template <typename Refs>
+        constexpr storage(storage_order_t, Refs&& refs)
+        : storage(std::piecewise_construct, refs_source<Refs>{ refs }) {}
+
+        template <typename Alloc>
+        storage(std::allocator_arg_t, Alloc const& a)
+        : storage(std::piecewise_construct, alloc_source<Alloc>{ a }) {}
+
+        template <typename Alloc, typename Refs>
+        storage(std::allocator_arg_t, Alloc const& a, storage_order_t, Refs&& refs)
+        : storage(std::piecewise_construct, alloc_refs_source<Alloc, Refs>{ a, refs }) {}
+
+        template <std::size_t S>
+        Element<S>& at() noexcept {
+            return at<S>(Bool<is_empty_element<Element<S>>::value>{});
+        }
+        template <std::size_t S>
+        Element<S> const& at() const noexcept {
+            return const_cast<storage&>(*this).template at<S>();
+        }
+
+        template <typename... U>
+        void assign(std::tuple<U...>&& refs) {
+            assign(all_indices{}, std::move(refs));
+        }
+
+        void swap(storage& that) {
+            swap(all_indices{}, that);
+        }
+
+        bool equal(storage const& that) const {
+            return equal(empty_indices{}, that) && bitwise_blocks<Sorted>::equal(*this, that);
+        }
+
+        std::uint64_t hash() const {
+            return bitwise_blocks<Sorted>::hash(*this);
+        }
+
+    private:
+        template <std::size_t S>
+        Element<S>& at(Bool<true>) noexcept {
+            return static_cast<EmptyBase<S>&>(*this).held();
+        }
+        template <std::size_t S>
+        Element<S>& at(Bool<false>) noexcept {
+            return chain_type::template at<S, Element<S>>(*this);
+        }
+
+        template <std::size_t... S, typename... U>
+        void assign(indices<S...>, std::tuple<U...>&& refs) {
+            (void)swallow{ 0, (at<S>() = std::get<S>(std::move(refs)), 0)... };
+        }
+
+        template <std::size_t... S>
+        void swap(indices<S...>, storage& that) {
+            using std::swap;
+            (void)swallow{ 0, (swap(at<S>(), that.template at<S>()), 0)... };
+        }
+
+        template <std::size_t... E>
+        bool equal(indices<E...>, storage const& that) const {
+            bool result = true;
+            (void)swallow{ 0, (result = result && at<E>() == that.template at<E>(), 0)... };
+            return result;
+        }
+    };
+
+    // checked lazily, so that tuples of other sizes can still declare the pair constructors
+    template <typename Ts, typename U1, typename U2>
+    struct pair_convertible : Bool<false> {};
+    template <typename T1, typename T2, typename U1, typename U2>
+    struct pair_convertible<std::tuple<T1, T2>, U1, U2>
+    : All<std::is_convertible<U1, T1>, std::is_convertible<U2, T2>> {};
 
     template <std::size_t I, typename... T>
-    using PackElement = TupleElement<I, std::tuple<T...>>;
+    using PackElement = Unannotated<ListElement<I, std::tuple<T...>>>;
+
+    // Decreasing alignment leaves no padding, and hot_cold checks itself, so there is nothing to
+    // check for them; other policies are compared with std::tuple, which is expensive to
+    // instantiate for long lists.
+    template <typename Storage, typename... T>
+    struct std_tuple_fits : Bool<sizeof(Storage) <= sizeof(std::tuple<Unannotated<T>...>)> {};
+    template <typename Storage, typename... T>
+    struct no_larger_than_std_tuple
+    : Conditional<Bool<std::is_same<LayoutPolicy<T...>, by_alignment>::value || std::is_same<LayoutPolicy<T...>, hot_cold>::value>,
+                  Bool<true>, std_tuple_fits<Storage, T...>> {};
+
+    template <typename Elements, typename Outer, typename Inner>
+    struct tuple_cat_impl;
 
     template <typename... T>
-    struct tuple : private OptimalStorage<T...> {
-    //private:
-        using storage_type = OptimalStorage<T...>;
+    struct tuple : private storage<Held<OptimalStorage<T...>>> {
+    private:
+        using storage_type = storage<Held<OptimalStorage<T...>>>;
         using to_interface = MapToInterface<T...>;
         using to_storage = MapToStorage<T...>;
-        template <typename... U>
-        using MapFor = ConvertLayoutMap<typename tuple<U...>::to_interface, to_interface>;
+
+        static_assert(no_larger_than_std_tuple<storage_type, T...>::value,
+            "layout policy makes the tuple larger than std::tuple");
 
     public:
         constexpr tuple() = default;
 
-        explicit tuple(T const&... t)
-        : storage_type { forward_shuffled(to_interface{}, t...) } {
-            static_assert(All<std::is_copy_constructible<T>...>::value,
+        explicit tuple(Unannotated<T> const&... t)
+        : storage_type(storage_order_t{}, forward_shuffled(to_interface{}, t...)) {
+            static_assert(All<std::is_copy_constructible<Unannotated<T>>...>::value,
                 "all elements must be copy constructible");
         }
         template <typename... U,
-                  EnableIf<pairwise_convertible<std::tuple<U...>, std::tuple<T...>>>...>
+                  EnableIf<pairwise_convertible<std::tuple<U...>, std::tuple<Unannotated<T>...>>>...>
         explicit tuple(U&&... u)
-        : storage_type { forward_shuffled(to_interface{}, std::forward<U>(u)...) } {
+        : storage_type(storage_order_t{}, forward_shuffled(to_interface{}, std::forward<U>(u)...)) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "number of arguments must match tuple size");
         }
@@ -295,31 +1545,29 @@ namespace my {
         tuple(tuple&&) = default;
 
         template <typename... U,
-                  EnableIf<std::is_constructible<T, U const&>...>...>
+                  EnableIf<std::is_constructible<Unannotated<T>, Unannotated<U> const&>...>...>
         constexpr tuple(tuple<U...> const& t)
-        : storage_type { forward_shuffled_tuple(MapFor<U...>{}, t) } {
+        : storage_type(storage_order_t{}, forward_shuffled_tuple(to_interface{}, t)) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "source tuple size must match destination tuple size");
         }
         template <typename... U,
-                  EnableIf<std::is_constructible<T, U&&>...>...>
+                  EnableIf<std::is_constructible<Unannotated<T>, Unannotated<U>&&>...>...>
         constexpr tuple(tuple<U...>&& t)
-        : storage_type { forward_shuffled_tuple(MapFor<U...>{}, std::move(t)) } {
+        : storage_type(storage_order_t{}, forward_shuffled_tuple(to_interface{}, std::move(t))) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "source tuple size must match destination tuple size");
         }
 
         template <typename U1, typename U2,
-                  EnableIf<std::is_convertible<U1 const&, PackElement<0, T...>>,
-                           std::is_convertible<U2 const&, PackElement<1, T...>>>...>
+                  EnableIf<pair_convertible<std::tuple<Unannotated<T>...>, U1 const&, U2 const&>>...>
         constexpr tuple(std::pair<U1, U2> const& p)
         : tuple { p.first, p.second } {
             static_assert(sizeof...(T) == 2,
                 "tuple size must be 2");
         }
         template <typename U1, typename U2,
-                  EnableIf<std::is_convertible<U1 const&, PackElement<0, T...>>,
-                           std::is_convertible<U2 const&, PackElement<1, T...>>>...>
+                  EnableIf<pair_convertible<std::tuple<Unannotated<T>...>, U1 const&, U2 const&>>...>
         constexpr tuple(std::pair<U1, U2>&& p)
         : tuple { std::move(p.first), std::move(p.second) } {
             static_assert(sizeof...(T) == 2,
@@ -327,71 +1575,71 @@ namespace my {
         }
 
         template <typename... U,
-                  EnableIf<std::is_constructible<T, U const&>...>...>
+                  EnableIf<std::is_constructible<Unannotated<T>, U const&>...>...>
         constexpr tuple(std::tuple<U...> const& t)
-        : tuple { forward_shuffled_tuple(to_interface{}, t) } {
+        : storage_type(storage_order_t{}, forward_shuffled_tuple(to_interface{}, t)) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "source tuple size must match destination tuple size");
         }
         template <typename... U,
-                  EnableIf<std::is_constructible<T, U&&>...>...>
+                  EnableIf<std::is_constructible<Unannotated<T>, U&&>...>...>
         constexpr tuple(std::tuple<U...>&& t)
-        : tuple { forward_shuffled_tuple(to_interface{}, std::move(t)) } {
+        : storage_type(storage_order_t{}, forward_shuffled_tuple(to_interface{}, std::move(t))) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "source tuple size must match destination tuple size");
         }
 
         template <typename Alloc>
         tuple(std::allocator_arg_t tag, Alloc const& a)
-        : storage_type { tag, a } {}
+        : storage_type(tag, a) {}
 
         template <typename Alloc>
-        tuple(std::allocator_arg_t tag, Alloc const& a, T const&... t)
-        : storage_type { tag, a, forward_shuffled(to_interface{}, t...) } {
-            static_assert(All<std::is_copy_constructible<T>...>::value,
+        tuple(std::allocator_arg_t tag, Alloc const& a, Unannotated<T> const&... t)
+        : storage_type(tag, a, storage_order_t{}, forward_shuffled(to_interface{}, t...)) {
+            static_assert(All<std::is_copy_constructible<Unannotated<T>>...>::value,
                 "all elements must be copy constructible");
         }
+        // the elements get the allocator too, so they can be built from types that only convert
+        // explicitly, like a std::string into a string with another allocator
         template <typename Alloc, typename... U,
-                  EnableIf<pairwise_convertible<std::tuple<U...>, std::tuple<T...>>>...>
+                  EnableIf<pairwise_constructible<std::tuple<U...>, std::tuple<Unannotated<T>...>>>...>
         explicit tuple(std::allocator_arg_t tag, Alloc const& a, U&&... u)
-        : storage_type { tag, a, forward_shuffled(to_interface{}, std::forward<U>(u)...) } {
+        : storage_type(tag, a, storage_order_t{}, forward_shuffled(to_interface{}, std::forward<U>(u)...)) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "number of arguments must match tuple size");
         }
 
         template <typename Alloc>
         tuple(std::allocator_arg_t tag, Alloc const& a, tuple const& t)
-        : storage_type { tag, a, t } {}
+        : storage_type(tag, a, storage_order_t{}, forward_shuffled_tuple(to_interface{}, t)) {}
         template <typename Alloc>
         tuple(std::allocator_arg_t tag, Alloc const& a, tuple&& t)
-        : storage_type { tag, a, std::move(t) } {}
+        : storage_type(tag, a, storage_order_t{}, forward_shuffled_tuple(to_interface{}, std::move(t))) {}
 
         template <typename Alloc, typename... U,
-                  EnableIf<std::is_constructible<T, U const&>...>...>
+                  EnableIf<std::is_constructible<Unannotated<T>, Unannotated<U> const&>...>...>
         constexpr tuple(std::allocator_arg_t tag, Alloc const& a, tuple<U...> const& t)
-        : storage_type { tag, a, forward_shuffled_tuple(MapFor<U...>{}, t) } {
+        : storage_type(tag, a, storage_order_t{}, forward_shuffled_tuple(to_interface{}, t)) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "source tuple size must match destination tuple size");
         }
         template <typename Alloc, typename... U,
-                  EnableIf<std::is_constructible<T, U&&>...>...>
+                  EnableIf<std::is_constructible<Unannotated<T>, Unannotated<U>&&>...>...>
         constexpr tuple(std::allocator_arg_t tag, Alloc const& a, tuple<U...>&& t)
-        : storage_type { tag, a, forward_shuffled_tuple(MapFor<U...>{}, std::move(t)) } {
+        : storage_type(tag, a, storage_order_t{}, forward_shuffled_tuple(to_interface{}, std::move(t))) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "source tuple size must match destination tuple size");
         }
 
         template <typename Alloc, typename U1, typename U2,
-                  EnableIf<std::is_convertible<U1 const&, PackElement<0, T...>>,
-                           std::is_convertible<U2 const&, PackElement<1, T...>>>...>
+                  EnableIf<pair_convertible<std::tuple<Unannotated<T>...>, U1 const&, U2 const&>>...>
         constexpr tuple(std::allocator_arg_t tag, Alloc const& a, std::pair<U1, U2> const& p)
         : tuple { tag, a, p.first, p.second } {
             static_assert(sizeof...(T) == 2,
                 "tuple size must be 2");
         }
         template <typename Alloc, typename U1, typename U2,
-                  EnableIf<std::is_convertible<U1 const&, PackElement<0, T...>>,
-                           std::is_convertible<U2 const&, PackElement<1, T...>>>...>
+                  EnableIf<pair_convertible<std::tuple<Unannotated<T>...>, U1 const&, U2 const&>>...>
         constexpr tuple(std::allocator_arg_t tag, Alloc const& a, std::pair<U1, U2>&& p)
         : tuple { tag, a, std::move(p.first), std::move(p.second) } {
             static_assert(sizeof...(T) == 2,
@@ -399,16 +1647,16 @@ namespace my {
         }
 
         template <typename Alloc, typename... U,
-                  EnableIf<std::is_constructible<T, U const&>...>...>
+                  EnableIf<std::is_constructible<Unannotated<T>, U const&>...>...>
         constexpr tuple(std::allocator_arg_t tag, Alloc const& a, std::tuple<U...> const& t)
-        : tuple { tag, a, forward_shuffled_tuple(to_interface{}, t) } {
+        : storage_type(tag, a, storage_order_t{}, forward_shuffled_tuple(to_interface{}, t)) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "source tuple size must match destination tuple size");
         }
         template <typename Alloc, typename... U,
-                  EnableIf<std::is_constructible<T, U&&>...>...>
+                  EnableIf<std::is_constructible<Unannotated<T>, U&&>...>...>
         constexpr tuple(std::allocator_arg_t tag, Alloc const& a, std::tuple<U...>&& t)
-        : tuple { tag, a, forward_shuffled_tuple(to_interface{}, std::move(t)) } {
+        : storage_type(tag, a, storage_order_t{}, forward_shuffled_tuple(to_interface{}, std::move(t))) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "source tuple size must match destination tuple size");
         }
@@ -420,18 +1668,18 @@ namespace my {
         tuple& operator=(tuple<U...> const& t) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "tuples can only be assigned to tuples with the same size");
-            static_assert(All<std::is_assignable<T&, U const&>...>::value,
+            static_assert(All<std::is_assignable<Unannotated<T>&, Unannotated<U> const&>...>::value,
                 "all elements must be assignable to the corresponding element");
-            storage_type::operator=(forward_shuffled_tuple(MapFor<U...>{}, t));
+            storage_type::assign(forward_shuffled_tuple(to_interface{}, t));
             return *this;
         }
         template <typename... U>
         tuple& operator=(tuple<U...>&& t) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "tuples can only be assigned to tuples with the same size");
-            static_assert(All<std::is_assignable<T&, U&&>...>::value,
+            static_assert(All<std::is_assignable<Unannotated<T>&, Unannotated<U>&&>...>::value,
                 "all elements must be move-assignable to the corresponding element");
-            storage_type::operator=(forward_shuffled_tuple(MapFor<U...>{}, std::move(t)));
+            storage_type::assign(forward_shuffled_tuple(to_interface{}, std::move(t)));
             return *this;
         }
 
@@ -443,7 +1691,7 @@ namespace my {
                 "first pair element must be assignable to first tuple element");
             static_assert(std::is_assignable<PackElement<1, T...>&, U2 const&>::value,
                 "second pair element must be assignable to second tuple element");
-            storage_type::operator=(forward_shuffled(to_interface{}, p.first, p.second));
+            storage_type::assign(forward_shuffled(to_interface{}, p.first, p.second));
             return *this;
         }
         template <typename U1, typename U2>
@@ -454,7 +1702,7 @@ namespace my {
                 "first pair element must be move-assignable to first tuple element");
             static_assert(std::is_assignable<PackElement<1, T...>&, U2&&>::value,
                 "second pair element must be move-assignable to second tuple element");
-            storage_type::operator=(forward_shuffled(to_interface{}, std::move(p.first), std::move(p.second)));
+            storage_type::assign(forward_shuffled(to_interface{}, std::move(p.first), std::move(p.second)));
             return *this;
         }
 
@@ -462,51 +1710,84 @@ namespace my {
         tuple& operator=(std::tuple<U...> const& t) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "tuples can only be assigned to tuples with the same size");
-            static_assert(All<std::is_assignable<T&, U const&>...>::value,
+            static_assert(All<std::is_assignable<Unannotated<T>&, U const&>...>::value,
                 "all elements must be assignable to the corresponding element");
-            storage_type::operator=(forward_shuffled_tuple(to_interface{}, t));
+            storage_type::assign(forward_shuffled_tuple(to_interface{}, t));
             return *this;
         }
         template <typename... U>
         tuple& operator=(std::tuple<U...>&& t) {
             static_assert(sizeof...(T) == sizeof...(U),
                 "tuples can only be assigned to tuples with the same size");
-            static_assert(All<std::is_assignable<T&, U&&>...>::value,
+            static_assert(All<std::is_assignable<Unannotated<T>&, U&&>...>::value,
                 "all elements must be move-assignable to the corresponding element");
-            storage_type::operator=(forward_shuffled_tuple(to_interface{}, std::move(t)));
+            storage_type::assign(forward_shuffled_tuple(to_interface{}, std::move(t)));
             return *this;
         }
 
         void swap(tuple& t)
-        noexcept(noexcept(std::declval<storage_type>().swap(std::declval<storage_type>()))) {
+        noexcept(All<is_nothrow_swappable<Unannotated<T>>...>::value) {
             storage_type::swap(t);
         }
 
+    private:
+        template <typename Refs>
+        tuple(storage_order_t tag, Refs&& refs)
+        : storage_type(tag, std::forward<Refs>(refs)) {}
+
         template <typename... U>
         friend class tuple;
+        template <typename Elements, typename Outer, typename Inner>
+        friend struct tuple_cat_impl;
         template <std::size_t I, typename... U>
-        friend TupleElement<I, std::tuple<U...>>& get(tuple<U...>& t);
+        friend PackElement<I, U...>& get(tuple<U...>& t);
         template <std::size_t I, typename... U>
-        friend TupleElement<I, std::tuple<U...>>&& get(tuple<U...>&& t);
+        friend PackElement<I, U...>&& get(tuple<U...>&& t);
         template <std::size_t I, typename... U>
-        friend TupleElement<I, std::tuple<U...>> const& get(tuple<U...> const& t);
-        template <typename... L, typename... R>
-        friend bool operator==(tuple<L...> const& l, tuple<R...> const& r);
-        template <typename... L, typename... R>
-        friend bool operator<(tuple<L...> const& l, tuple<R...> const& r);
+        friend PackElement<I, U...> const& get(tuple<U...> const& t);
+        template <typename... U>
+        friend bool operator==(tuple<U...> const& t, tuple<U...> const& u);
+        template <typename... U>
+        friend std::size_t hash_value(tuple<U...> const& t);
+    };
+
+    template <>
+    struct tuple<> {
+        constexpr tuple() = default;
+        template <typename Alloc>
+        tuple(std::allocator_arg_t, Alloc const&) {}
+        template <typename Alloc>
+        tuple(std::allocator_arg_t, Alloc const&, tuple const&) {}
+        constexpr tuple(std::tuple<> const&) {}
+
+        void swap(tuple&) noexcept {}
+
+    private:
+        tuple(storage_order_t, std::tuple<>) {}
+
+        bool equal(tuple const&) const { return true; }
+        std::uint64_t hash() const { return 0; }
+
+        template <typename Elements, typename Outer, typename Inner>
+        friend struct tuple_cat_impl;
+        template <typename... U>
+        friend bool operator==(tuple<U...> const& t, tuple<U...> const& u);
+        template <typename... U>
+        friend std::size_t hash_value(tuple<U...> const& t);
     };
 
     template <std::size_t I, typename... U>
-    TupleElement<I, std::tuple<U...>>& get(tuple<U...>& t) {
-        return std::get<TupleElement<I, MapToStorage<U...>>::value>(t);
+    PackElement<I, U...>& get(tuple<U...>& t) {
+        return t.template at<IndexAt<I, MapToStorage<U...>>::value>();
     }
     template <std::size_t I, typename... U>
-    TupleElement<I, std::tuple<U...>>&& get(tuple<U...>&& t) {
-        return std::get<TupleElement<I, MapToStorage<U...>>::value>(t);
+    PackElement<I, U...>&& get(tuple<U...>&& t) {
+        using element_type = PackElement<I, U...>;
+        return std::forward<element_type>(t.template at<IndexAt<I, MapToStorage<U...>>::value>());
     }
     template <std::size_t I, typename... U>
-    TupleElement<I, std::tuple<U...>> const& get(tuple<U...> const& t) {
-        return std::get<TupleElement<I, MapToStorage<U...>>::value>(t);
+    PackElement<I, U...> const& get(tuple<U...> const& t) {
+        return t.template at<IndexAt<I, MapToStorage<U...>>::value>();
     }
 
     template <typename... T>
@@ -522,19 +1803,128 @@ namespace my {
         return tuple<T&...>(t...);
     }
 
+    // tuple_cat
+    //
+    // The result has its own optimal layout, and each of its elements is constructed in place,
+    // straight from the corresponding element of the arguments.
+    template <typename Tuple>
+    struct tuple_elements;
+    template <typename... T>
+    struct tuple_elements<tuple<T...>> : identity<std::tuple<T...>> {};
+    template <typename... T>
+    struct tuple_elements<std::tuple<T...>> : identity<std::tuple<T...>> {};
+    template <typename T1, typename T2>
+    struct tuple_elements<std::pair<T1, T2>> : identity<std::tuple<T1, T2>> {};
+    template <typename Tuple>
+    using TupleElements = typename tuple_elements<Decay<Tuple>>::type;
+
+    template <typename List>
+    struct as_tuple;
+    template <typename... T>
+    struct as_tuple<std::tuple<T...>> : identity<tuple<T...>> {};
+
+    template <typename... Tuples>
+    using CatElements = Concat<TupleElements<Tuples>...>;
+    template <typename... Tuples>
+    using CatResult = typename as_tuple<CatElements<Tuples...>>::type;
+
+    template <typename... Lists>
+    struct concat_indices;
+    template <>
+    struct concat_indices<> : identity<indices<>> {};
+    template <std::size_t... I>
+    struct concat_indices<indices<I...>> : identity<indices<I...>> {};
+    template <std::size_t... I, std::size_t... J, typename... Rest>
+    struct concat_indices<indices<I...>, indices<J...>, Rest...>
+    : concat_indices<indices<I..., J...>, Rest...> {};
+    template <typename... Lists>
+    using ConcatIndices = typename concat_indices<Lists...>::type;
+
+    // which argument, and which element of that argument, each result element comes from
+    template <std::size_t J, typename Indices>
+    struct repeat_index;
+    template <std::size_t J, std::size_t... I>
+    struct repeat_index<J, indices<I...>> : identity<indices<(0 * I + J)...>> {};
+
+    template <typename Tuples, typename Indices = IndicesFor<Tuples>>
+    struct cat_maps;
+    template <typename... Tuples, std::size_t... J>
+    struct cat_maps<std::tuple<Tuples...>, indices<J...>> {
+        using outer = ConcatIndices<typename repeat_index<J, IndicesFor<TupleElements<Tuples>>>::type...>;
+        using inner = ConcatIndices<IndicesFor<TupleElements<Tuples>>...>;
+    };
+
+    template <typename... E, typename Outer, typename Inner>
+    struct tuple_cat_impl<std::tuple<E...>, Outer, Inner> {
+        template <typename Args>
+        static tuple<E...> make(Args&& args) {
+            return make(MapToInterface<E...>{}, std::forward<Args>(args));
+        }
+        template <std::size_t... I, typename Args>
+        static tuple<E...> make(indices<I...>, Args&& args) {
+            using std::get;
+            return tuple<E...>(storage_order_t{}, std::forward_as_tuple(
+                get<IndexAt<I, Inner>::value>(
+                    std::get<IndexAt<I, Outer>::value>(std::forward<Args>(args)))...));
+        }
+    };
+
+    template <typename... Tuples>
+    CatResult<Tuples...> tuple_cat(Tuples&&... tuples) {
+        using maps = cat_maps<std::tuple<Tuples...>>;
+        using impl = tuple_cat_impl<CatElements<Tuples...>, typename maps::outer, typename maps::inner>;
+        return impl::make(std::forward_as_tuple(std::forward<Tuples>(tuples)...));
+    }
+
     template <typename... T>
     void swap(tuple<T...>& x, tuple<T...>& y)
     noexcept(noexcept(std::declval<tuple<T...>&>().swap(std::declval<tuple<T...>&>()))) {
         x.swap(y);
     }
 
+    // comparing elements in the order given by a map, with one expansion instead of a
+    // recursion per element
+    template <typename Map>
+    struct compare_in_order;
+    template <std::size_t... I>
+    struct compare_in_order<indices<I...>> {
+        template <typename T, typename U>
+        static bool equal(T const& t, U const& u) {
+            bool result = true;
+            (void)swallow{ 0, (result = result && get<I>(t) == get<I>(u), 0)... };
+            return result;
+        }
+        template <typename T, typename U>
+        static bool less(T const& t, U const& u) {
+            // negative once some element is less, positive once some element is greater
+            int order = 0;
+            (void)swallow{ 0, (order = order != 0? order
+                                     : get<I>(t) < get<I>(u)? -1
+                                     : get<I>(u) < get<I>(t)? 1
+                                     : 0, 0)... };
+            return order < 0;
+        }
+    };
+
+    // Tuples of different types compare element by element, in interface order. Tuples of the
+    // same type compare in storage order instead, a block at a time where they can; the result
+    // is the same, only the order in which the elements are compared differs.
     template <typename... T, typename... U>
     bool operator==(tuple<T...> const& t, tuple<U...> const& u) {
-        return static_cast<OptimalStorage<T...> const&>(t) == u;
+        static_assert(sizeof...(T) == sizeof...(U),
+            "tuples can only be compared to tuples with the same size");
+        return compare_in_order<IndicesUpTo<sizeof...(T)>>::equal(t, u);
     }
+    template <typename... T>
+    bool operator==(tuple<T...> const& t, tuple<T...> const& u) {
+        return t.equal(u);
+    }
+    // lexicographic in interface order, like std::tuple, whatever the storage order
     template <typename... T, typename... U>
     bool operator<(tuple<T...> const& t, tuple<U...> const& u) {
-        return static_cast<OptimalStorage<T...> const&>(t) < u;
+        static_assert(sizeof...(T) == sizeof...(U),
+            "tuples can only be compared to tuples with the same size");
+        return compare_in_order<IndicesUpTo<sizeof...(T)>>::less(t, u);
     }
     template <typename... T, typename... U>
     bool operator!=(tuple<T...> const& t, tuple<U...> const& u) {
@@ -552,17 +1942,31 @@ namespace my {
     bool operator>=(tuple<T...> const& t, tuple<U...> const& u) {
         return !(t < u);
     }
+
+    // hashes blocks of bytes where equality compares them, and combines the std::hash of
+    // everything else; empty elements are left out
+    template <typename... T>
+    std::size_t hash_value(tuple<T...> const& t) {
+        return static_cast<std::size_t>(t.hash());
+    }
 } // namespace my
 
 namespace std {
     template <typename... T>
-    struct tuple_size< ::my::tuple<T...>> : tuple_size< ::std::tuple<T...>> {};
+    struct tuple_size< ::my::tuple<T...>> : integral_constant<size_t, sizeof...(T)> {};
 
     template <size_t I, typename... T>
-    struct tuple_element<I, ::my::tuple<T...>> : tuple_element<I, ::std::tuple<T...>> {};
+    struct tuple_element<I, ::my::tuple<T...>> : ::my::identity< ::my::PackElement<I, T...>> {};
 
     template <typename... T, typename Alloc>
     struct uses_allocator< ::my::tuple<T...>, Alloc> : ::std::true_type {};
+
+    template <typename... T>
+    struct hash< ::my::tuple<T...>> {
+        size_t operator()(::my::tuple<T...> const& t) const {
+            return ::my::hash_value(t);
+        }
+    };
 } // namespace std
 
 #endif // MY_TUPLE_HPP
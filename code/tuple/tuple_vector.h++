@@ -0,0 +1,234 @@
+// Growable array of optimal layout tuples
+//
+// Written in 2026 by the flamingdangerzone contributors
+//
+// To the extent possible under law, the author(s) have dedicated all copyright and related
+// and neighboring rights to this software to the public domain worldwide. This software is
+// distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along with this software.
+// If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+#ifndef MY_TUPLE_VECTOR_HPP
+#define MY_TUPLE_VECTOR_HPP
+
+#include "tuple.h++"
+#include "relocate.h++"
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <cstddef>
+
+namespace my {
+    // Rows are whole tuples, back to back. Growing, inserting and erasing relocate the rows,
+    // which is a single memcpy or memmove when the tuple is trivially relocatable.
+    template <typename... T>
+    struct tuple_vector {
+        using value_type = tuple<T...>;
+        using reference = value_type&;
+        using const_reference = value_type const&;
+        using iterator = value_type*;
+        using const_iterator = value_type const*;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        tuple_vector() noexcept : first(nullptr), count(0), cap(0) {}
+
+        tuple_vector(tuple_vector const& that) : tuple_vector() {
+            reserve(that.count);
+            for(auto const& row : that) push_back(row);
+        }
+        tuple_vector(tuple_vector&& that) noexcept : tuple_vector() {
+            swap(that);
+        }
+
+        tuple_vector& operator=(tuple_vector that) noexcept {
+            swap(that);
+            return *this;
+        }
+
+        ~tuple_vector() {
+            clear();
+            deallocate(first, cap);
+        }
+
+        void swap(tuple_vector& that) noexcept {
+            using std::swap;
+            swap(first, that.first);
+            swap(count, that.count);
+            swap(cap, that.cap);
+        }
+
+        size_type size() const noexcept { return count; }
+        size_type capacity() const noexcept { return cap; }
+        bool empty() const noexcept { return count == 0; }
+
+        value_type* data() noexcept { return first; }
+        value_type const* data() const noexcept { return first; }
+
+        reference operator[](size_type i) noexcept { return first[i]; }
+        const_reference operator[](size_type i) const noexcept { return first[i]; }
+
+        reference front() noexcept { return first[0]; }
+        const_reference front() const noexcept { return first[0]; }
+        reference back() noexcept { return first[count-1]; }
+        const_reference back() const noexcept { return first[count-1]; }
+
+        iterator begin() noexcept { return first; }
+        iterator end() noexcept { return first + count; }
+        const_iterator begin() const noexcept { return first; }
+        const_iterator end() const noexcept { return first + count; }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        void reserve(size_type n) {
+            if(n > cap) reallocate(n);
+        }
+
+        void push_back(value_type const& t) {
+            emplace_back(t);
+        }
+        void push_back(value_type&& t) {
+            emplace_back(std::move(t));
+        }
+        template <typename... U>
+        reference emplace_back(U&&... u) {
+            if(count == cap) return grow_and_emplace_back(std::forward<U>(u)...);
+            ::new(static_cast<void*>(first + count)) value_type(std::forward<U>(u)...);
+            return first[count++];
+        }
+
+        // The rows after the insertion point are shifted in one go. The new row is built aside
+        // first, since the arguments may refer to the rows that shift, and then relocated into
+        // the gap like the others, so nothing can throw once they have moved.
+        template <typename... U>
+        iterator emplace(const_iterator position, U&&... u) {
+            static_assert(is_relocatable<value_type>::value,
+                "inserting needs trivially relocatable or nothrow movable tuples");
+            size_type i = position - first;
+            if(i == count) {
+                emplace_back(std::forward<U>(u)...);
+                return first + i;
+            }
+            if(count == cap) return grow_and_emplace(i, std::forward<U>(u)...);
+            layout<sizeof(value_type), alignof(value_type)> buffer;
+            auto row = ::new(static_cast<void*>(&buffer)) value_type(std::forward<U>(u)...);
+            my::relocate_n(first + i, count - i, first + i + 1);
+            my::relocate_n(row, 1, first + i);
+            ++count;
+            return first + i;
+        }
+        iterator insert(const_iterator position, value_type const& t) {
+            return emplace(position, t);
+        }
+        iterator insert(const_iterator position, value_type&& t) {
+            return emplace(position, std::move(t));
+        }
+
+        iterator erase(const_iterator position) noexcept {
+            return erase(position, position + 1);
+        }
+        iterator erase(const_iterator from, const_iterator to) noexcept {
+            static_assert(is_relocatable<value_type>::value,
+                "erasing needs trivially relocatable or nothrow movable tuples");
+            iterator f = first + (from - first);
+            iterator l = first + (to - first);
+            for(iterator p = f; p != l; ++p) p->~value_type();
+            my::relocate_n(l, end() - l, f);
+            count -= l - f;
+            return f;
+        }
+
+        void pop_back() noexcept {
+            first[--count].~value_type();
+        }
+
+        void clear() noexcept {
+            for(size_type i = 0; i != count; ++i) first[i].~value_type();
+            count = 0;
+        }
+
+    private:
+        value_type* first;
+        size_type count;
+        size_type cap;
+
+        static value_type* allocate(size_type n) {
+            return std::allocator<value_type>{}.allocate(n);
+        }
+        static void deallocate(value_type* p, size_type n) noexcept {
+            if(p) std::allocator<value_type>{}.deallocate(p, n);
+        }
+
+        size_type grow_size() const noexcept {
+            return cap == 0? 8 : 2*cap;
+        }
+
+        void reallocate(size_type n) {
+            auto fresh = allocate(n);
+            try {
+                my::uninitialized_relocate(first, first + count, fresh);
+            } catch(...) {
+                deallocate(fresh, n);
+                throw;
+            }
+            deallocate(first, cap);
+            first = fresh;
+            cap = n;
+        }
+
+        // the new row is built before the old ones move, since the arguments may refer to them
+        template <typename... U>
+        reference grow_and_emplace_back(U&&... u) {
+            size_type n = grow_size();
+            auto fresh = allocate(n);
+            try {
+                ::new(static_cast<void*>(fresh + count)) value_type(std::forward<U>(u)...);
+            } catch(...) {
+                deallocate(fresh, n);
+                throw;
+            }
+            try {
+                my::uninitialized_relocate(first, first + count, fresh);
+            } catch(...) {
+                fresh[count].~value_type();
+                deallocate(fresh, n);
+                throw;
+            }
+            deallocate(first, cap);
+            first = fresh;
+            cap = n;
+            return first[count++];
+        }
+
+        // the new row is built in place, and the old rows are relocated around it
+        template <typename... U>
+        iterator grow_and_emplace(size_type i, U&&... u) {
+            size_type n = grow_size();
+            auto fresh = allocate(n);
+            try {
+                ::new(static_cast<void*>(fresh + i)) value_type(std::forward<U>(u)...);
+            } catch(...) {
+                deallocate(fresh, n);
+                throw;
+            }
+            my::relocate_n(first, i, fresh);
+            my::relocate_n(first + i, count - i, fresh + i + 1);
+            deallocate(first, cap);
+            first = fresh;
+            cap = n;
+            ++count;
+            return first + i;
+        }
+    };
+
+    template <typename... T>
+    void swap(tuple_vector<T...>& x, tuple_vector<T...>& y) noexcept {
+        x.swap(y);
+    }
+} // namespace my
+
+#endif // MY_TUPLE_VECTOR_HPP
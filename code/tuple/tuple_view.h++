@@ -0,0 +1,401 @@
+// Zero-copy views of serialized optimal layout tuples
+//
+// Written in 2026 by the flamingdangerzone contributors
+//
+// To the extent possible under law, the author(s) have dedicated all copyright and related
+// and neighboring rights to this software to the public domain worldwide. This software is
+// distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along with this software.
+// If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+#ifndef MY_TUPLE_VIEW_HPP
+#define MY_TUPLE_VIEW_HPP
+
+#include "tuple.h++"
+
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define MY_TUPLE_VIEW_MMAP
+#endif
+
+namespace my {
+    // Layout descriptor
+    //
+    // A tuple of trivially copyable elements is its bytes, and its layout depends only on the
+    // element types and the layout policy. The descriptor gives that layout at compile time, in
+    // interface order, together with a hash of it that readers check before trusting the bytes.
+    enum class byte_order { little, big };
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    constexpr byte_order native_byte_order = byte_order::big;
+#else
+    constexpr byte_order native_byte_order = byte_order::little;
+#endif
+
+    // offsets of the elements of a held list, in storage order; empty elements are at zero
+    template <typename Sorted,
+              typename NonEmpty = typename partition_empty<typename Sorted::list>::non_empty,
+              typename Positions = IndicesFor<typename Sorted::list>>
+    struct storage_offsets;
+    template <typename Sorted, std::size_t... V, std::size_t... S>
+    struct storage_offsets<Sorted, indices<V...>, indices<S...>> {
+    private:
+        static constexpr std::size_t n = sizeof...(V);
+        using aligns = index_array<indices<std::alignment_of<member<HeldElement<V, Sorted>>>::value...>>;
+        using sizes = index_array<indices<sizeof(member<HeldElement<V, Sorted>>)...>>;
+        using stored = index_array<indices<!is_empty_element<HeldElement<S, Sorted>>::value...>>;
+
+        static constexpr std::size_t offset(std::size_t s) {
+            return !stored::values[s]? 0
+                 : storage_offset(aligns::values, sizes::values, n, array_sum(stored::values, 0, s));
+        }
+
+    public:
+        using type = indices<offset(S)...>;
+    };
+
+    // what kind of value an element holds, so that the schema tells apart an int from a float
+    enum class value_kind : std::size_t { other, boolean, enumeration, signed_integer, unsigned_integer, floating_point };
+    template <typename T>
+    struct kind_of
+    : std::integral_constant<value_kind,
+        std::is_same<T, bool>::value? value_kind::boolean
+        : std::is_enum<T>::value? value_kind::enumeration
+        : std::is_integral<T>::value && std::is_signed<T>::value? value_kind::signed_integer
+        : std::is_integral<T>::value? value_kind::unsigned_integer
+        : std::is_floating_point<T>::value? value_kind::floating_point
+        : value_kind::other> {};
+
+    // FNV-1a style mixing, combined over halves so that long lists do not nest deeply
+    constexpr std::uint64_t schema_prime = 0x100000001b3;
+    constexpr std::uint64_t schema_basis = 0xcbf29ce484222325;
+    constexpr std::uint64_t schema_mix(std::uint64_t h, std::uint64_t v) {
+        return (h ^ v) * schema_prime;
+    }
+    constexpr std::uint64_t schema_range(std::size_t const* a, std::size_t first, std::size_t last) {
+        return last - first == 0? schema_basis
+             : last - first == 1? schema_mix(schema_basis, a[first])
+             : schema_mix(schema_mix(schema_range(a, first, midpoint(first, last)), last - first),
+                          schema_range(a, midpoint(first, last), last));
+    }
+
+    template <typename Tuple, typename Positions = IndicesFor<Tuple>>
+    struct layout_descriptor;
+    template <typename... T, std::size_t... I>
+    struct layout_descriptor<tuple<T...>, indices<I...>> {
+    private:
+        using by_storage = index_array<typename storage_offsets<Held<OptimalStorage<T...>>>::type>;
+        using to_storage = index_array<MapToStorage<T...>>;
+
+        template <std::size_t J>
+        using Element = PackElement<J, T...>;
+
+        using words = index_array<indices<
+            sizeof...(T), sizeof(tuple<T...>), alignof(tuple<T...>), std::size_t(native_byte_order),
+            by_storage::values[to_storage::values[I]]...,
+            sizeof(Element<I>)...,
+            std::alignment_of<Element<I>>::value...,
+            std::size_t(kind_of<Element<I>>::value)...>>;
+
+    public:
+        static constexpr std::size_t count = sizeof...(T);
+        static constexpr std::size_t size = sizeof(tuple<T...>);
+        static constexpr std::size_t align = alignof(tuple<T...>);
+        static constexpr byte_order order = native_byte_order;
+        // in interface order; never empty, because zero-length arrays are not allowed
+        static constexpr std::size_t offsets[sizeof...(T) + 1] = { by_storage::values[to_storage::values[I]]..., 0 };
+        static constexpr std::size_t sizes[sizeof...(T) + 1] = { sizeof(Element<I>)..., 0 };
+        static constexpr std::uint64_t schema = schema_range(words::values, 0, 4 + 4 * count);
+    };
+    template <typename... T, std::size_t... I>
+    constexpr std::size_t layout_descriptor<tuple<T...>, indices<I...>>::offsets[sizeof...(T) + 1];
+    template <typename... T, std::size_t... I>
+    constexpr std::size_t layout_descriptor<tuple<T...>, indices<I...>>::sizes[sizeof...(T) + 1];
+
+    template <typename... T>
+    struct is_serializable
+    : All<Bool<sizeof...(T) != 0>, std::is_trivially_copyable<tuple<T...>>,
+          Bool<!std::is_reference<T>::value>..., Bool<!std::is_pointer<Unannotated<T>>::value>...> {};
+
+    // Reads the elements of a serialized tuple in place. The bytes have to be aligned for the
+    // tuple, and to come from a layout with the same schema.
+    template <typename... T>
+    struct tuple_view {
+        static_assert(is_serializable<T...>::value,
+            "only non-empty tuples of trivially copyable values can be viewed");
+
+        using descriptor = layout_descriptor<tuple<T...>>;
+        using value_type = tuple<T...>;
+
+        explicit tuple_view(unsigned char const* bytes) noexcept : bytes(bytes) {}
+#if __cplusplus >= 201703L
+        explicit tuple_view(std::byte const* bytes) noexcept
+        : bytes(reinterpret_cast<unsigned char const*>(bytes)) {}
+#endif
+
+        unsigned char const* data() const noexcept { return bytes; }
+
+        // copies the whole tuple out
+        value_type load() const noexcept {
+            value_type t;
+            std::memcpy(static_cast<void*>(&t), bytes, sizeof(t));
+            return t;
+        }
+
+    private:
+        unsigned char const* bytes;
+
+        template <std::size_t I, typename... U>
+        friend PackElement<I, U...> const& get(tuple_view<U...> v) noexcept;
+    };
+
+    template <std::size_t I, typename... U>
+    PackElement<I, U...> const& get(tuple_view<U...> v) noexcept {
+        using descriptor = typename tuple_view<U...>::descriptor;
+        return *reinterpret_cast<PackElement<I, U...> const*>(v.bytes + descriptor::offsets[I]);
+    }
+
+    // File format
+    //
+    // A header with the schema, then the records back to back, each the bytes of one tuple
+    // with zeroed padding. The records start aligned for the tuple, so a page-aligned mapping
+    // of the whole file can be read in place. The record count is whatever fits in the file,
+    // so that appending needs no header update.
+    struct layout_mismatch : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    struct tuple_file_header {
+        unsigned char magic[8];
+        std::uint64_t schema;
+        std::uint64_t record_size;
+        std::uint64_t record_align;
+    };
+    constexpr unsigned char tuple_file_magic[8] = { 'm', 'y', 't', 'u', 'p', 'l', 'e', 1 };
+
+    template <typename Descriptor>
+    tuple_file_header make_header() noexcept {
+        tuple_file_header header;
+        std::memcpy(header.magic, tuple_file_magic, sizeof(header.magic));
+        header.schema = Descriptor::schema;
+        header.record_size = Descriptor::size;
+        header.record_align = Descriptor::align;
+        return header;
+    }
+    template <typename Descriptor>
+    constexpr std::size_t records_offset() {
+        return round_up(sizeof(tuple_file_header), Descriptor::align);
+    }
+
+    // throws layout_mismatch unless the bytes start with a header for this descriptor
+    template <typename Descriptor>
+    void check_header(unsigned char const* data, std::size_t size) {
+        tuple_file_header header;
+        if(size < records_offset<Descriptor>()) throw layout_mismatch("tuple file: no header");
+        std::memcpy(&header, data, sizeof(header));
+        if(std::memcmp(header.magic, tuple_file_magic, sizeof(header.magic)) != 0) {
+            throw layout_mismatch("tuple file: not a tuple file");
+        }
+        if(header.schema != Descriptor::schema || header.record_size != Descriptor::size
+           || header.record_align != Descriptor::align) {
+            throw layout_mismatch("tuple file: schema does not match");
+        }
+    }
+    // how many records a file of the given size holds, or layout_mismatch if one is cut short
+    template <typename Descriptor>
+    std::size_t record_count(std::size_t size) {
+        if((size - records_offset<Descriptor>()) % Descriptor::size != 0) {
+            throw layout_mismatch("tuple file: truncated record");
+        }
+        return (size - records_offset<Descriptor>()) / Descriptor::size;
+    }
+    template <typename Descriptor>
+    std::size_t check_records(unsigned char const* data, std::size_t size) {
+        check_header<Descriptor>(data, size);
+        return record_count<Descriptor>(size);
+    }
+
+    // the records in a buffer with a header, usually a whole mapped file
+    template <typename... T>
+    struct tuple_records {
+        using descriptor = layout_descriptor<tuple<T...>>;
+        using size_type = std::size_t;
+
+        tuple_records(unsigned char const* data, size_type size)
+        : first(data + records_offset<descriptor>()), count(check_records<descriptor>(data, size)) {}
+#if __cplusplus >= 201703L
+        tuple_records(std::byte const* data, size_type size)
+        : tuple_records(reinterpret_cast<unsigned char const*>(data), size) {}
+#endif
+
+        size_type size() const noexcept { return count; }
+        bool empty() const noexcept { return count == 0; }
+
+        tuple_view<T...> operator[](size_type i) const noexcept {
+            return tuple_view<T...>(first + i * descriptor::size);
+        }
+
+    private:
+        unsigned char const* first;
+        size_type count;
+    };
+
+    // Appends tuples to a file, a batch at a time. A new file gets a header; an existing one
+    // has to have the same schema.
+    template <typename... T>
+    struct tuple_writer {
+        static_assert(is_serializable<T...>::value,
+            "only non-empty tuples of trivially copyable values can be written");
+
+        using descriptor = layout_descriptor<tuple<T...>>;
+        using value_type = tuple<T...>;
+        using size_type = std::size_t;
+
+        static constexpr size_type default_batch_bytes = 1 << 20;
+
+        explicit tuple_writer(char const* path, size_type batch = default_batch_bytes / sizeof(value_type) + 1)
+        : file(std::fopen(path, "a+b")), batch(batch) {
+            if(!file) throw std::system_error(errno, std::generic_category(), "tuple file: cannot open");
+            try {
+                start();
+            } catch(...) {
+                std::fclose(file);
+                throw;
+            }
+            buffer.reserve(batch * descriptor::size);
+        }
+
+        tuple_writer(tuple_writer const&) = delete;
+        tuple_writer& operator=(tuple_writer const&) = delete;
+
+        // whatever is still buffered is lost if this fails; call flush() to find out
+        ~tuple_writer() {
+            try {
+                flush();
+            } catch(...) {}
+            std::fclose(file);
+        }
+
+        void append(value_type const& t) {
+            if(buffer.size() == batch * descriptor::size) flush();
+            buffer.resize(buffer.size() + descriptor::size);
+            copy_elements(buffer.data() + buffer.size() - descriptor::size, t, IndicesFor<std::tuple<T...>>{});
+        }
+        template <typename Iterator>
+        void append(Iterator first, Iterator last) {
+            for(; first != last; ++first) append(*first);
+        }
+
+        void flush() {
+            if(buffer.empty()) return;
+            write(buffer.data(), buffer.size());
+            buffer.clear();
+            if(std::fflush(file) != 0) throw std::system_error(errno, std::generic_category(), "tuple file: cannot write");
+        }
+
+    private:
+        std::FILE* file;
+        size_type batch;
+        std::vector<unsigned char> buffer;
+
+        void write(unsigned char const* data, size_type size) {
+            if(std::fwrite(data, 1, size, file) != size) {
+                throw std::system_error(errno, std::generic_category(), "tuple file: cannot write");
+            }
+        }
+
+        void start() {
+            if(std::fseek(file, 0, SEEK_END) != 0) throw std::system_error(errno, std::generic_category(), "tuple file: cannot seek");
+            long size = std::ftell(file);
+            if(size < 0) throw std::system_error(errno, std::generic_category(), "tuple file: cannot seek");
+            if(size == 0) {
+                unsigned char head[records_offset<descriptor>()] = {};
+                auto header = make_header<descriptor>();
+                std::memcpy(head, &header, sizeof(header));
+                write(head, sizeof(head));
+            } else {
+                unsigned char head[records_offset<descriptor>()];
+                std::rewind(file);
+                if(std::fread(head, 1, sizeof(head), file) != sizeof(head)) {
+                    throw layout_mismatch("tuple file: no header");
+                }
+                check_header<descriptor>(head, sizeof(head));
+                record_count<descriptor>(size_type(size));
+                // output cannot follow input without a positioning call in between
+                if(std::fseek(file, 0, SEEK_END) != 0) throw std::system_error(errno, std::generic_category(), "tuple file: cannot seek");
+            }
+        }
+
+        // element by element, so that padding stays zero and files are deterministic
+        template <std::size_t... I>
+        static void copy_elements(unsigned char* record, value_type const& t, indices<I...>) noexcept {
+            (void)swallow{ 0, (std::memcpy(record + descriptor::offsets[I], std::addressof(get<I>(t)), descriptor::sizes[I]), 0)... };
+        }
+    };
+
+#if defined(MY_TUPLE_VIEW_MMAP)
+    // a whole file, mapped read-only
+    struct mapped_file {
+        explicit mapped_file(char const* path) : bytes(nullptr), length(0) {
+            int fd = ::open(path, O_RDONLY);
+            if(fd < 0) throw std::system_error(errno, std::generic_category(), "mapped file: cannot open");
+            struct stat info;
+            if(::fstat(fd, &info) != 0) {
+                int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "mapped file: cannot stat");
+            }
+            length = std::size_t(info.st_size);
+            if(length > 0) {
+                void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(p == MAP_FAILED) {
+                    int error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "mapped file: cannot map");
+                }
+                bytes = static_cast<unsigned char const*>(p);
+            }
+            ::close(fd);
+        }
+
+        mapped_file(mapped_file&& that) noexcept : bytes(that.bytes), length(that.length) {
+            that.bytes = nullptr;
+            that.length = 0;
+        }
+        mapped_file& operator=(mapped_file that) noexcept {
+            std::swap(bytes, that.bytes);
+            std::swap(length, that.length);
+            return *this;
+        }
+
+        ~mapped_file() {
+            if(bytes) ::munmap(const_cast<unsigned char*>(bytes), length);
+        }
+
+        unsigned char const* data() const noexcept { return bytes; }
+        std::size_t size() const noexcept { return length; }
+
+    private:
+        unsigned char const* bytes;
+        std::size_t length;
+    };
+#endif
+#undef MY_TUPLE_VIEW_MMAP
+} // namespace my
+
+#endif // MY_TUPLE_VIEW_HPP